@@ -6,92 +6,459 @@
 
 #include <string.h>
 
+#include "fold.h"
+#include "known_headers.h"
+#include "hpack.h"
+#include "parse.h"
+#include "corpus.h"
+
 #define MY_CXT_KEY "HTTP::Headers::Fast::XS::_guts" XS_VERSION
 
+/* Default cap on the %standard_case entries handle_standard_case() adds;
+ * names evicted print title-cased from their key, see standard_case_name() */
+#define STANDARD_CASE_CACHE_LIMIT 10000
+
 typedef struct {
     HV *standard_case;
-    SV **translate;
+    bool translate; /* truth of $TRANSLATE_UNDERSCORE, kept by its set-magic */
+    SV *known_key[KNOWN_HEADER_COUNT];  /* known_headers[] names, as shared keys */
+
+    /* keys handle_standard_case() added to %standard_case, as shared
+     * strings, so they can be evicted once cache_limit is reached */
+    SV  **cache_keys;
+    IV  cache_size;
+    IV  cache_alloc;
+    IV  cache_limit; /* 0 means unbounded */
+    U32 cache_rand;
+
+    UV  cache_known;
+    UV  cache_hits;
+    UV  cache_misses;
+    UV  cache_evictions;
 } my_cxt_t;
 
 START_MY_CXT;
 
-void translate_underscore(pTHX_ char *field, int len) {
+/* Most field names fit in here; longer ones get a mortal buffer */
+#define FIELD_SCRATCH_SIZE 64
+
+/* A standardized field name; see handle_standard_case() */
+typedef struct {
+    const char *name;
+    STRLEN     len;
+    U32        hash; /* PERL_HASH() of name, computed once */
+    SV         *key; /* shared key SV for well-known names, or NULL */
+    char       buf[FIELD_SCRATCH_SIZE];
+} field_t;
+
+/* hv_common() on a standardized field: the hash is never recomputed and
+ * well-known names are stored with their shared key */
+#define field_common(hv, f, action, val)                                      \
+    ( (f)->key                                                                \
+      ? hv_common( (hv), (f)->key, NULL, 0, 0, (action), (val), (f)->hash )   \
+      : hv_common_key_len( (hv), (f)->name, (f)->len, (action), (val), (f)->hash ) )
+
+#define field_fetch(hv, f, lval) \
+    ( (SV **) field_common( (hv), (f), (lval) ? (HV_FETCH_JUST_SV | HV_FETCH_LVALUE) : HV_FETCH_JUST_SV, NULL ) )
+#define field_store(hv, f, val) \
+    ( (SV **) field_common( (hv), (f), HV_FETCH_ISSTORE | HV_FETCH_JUST_SV, (val) ) )
+#define field_exists(hv, f) \
+    cBOOL( field_common( (hv), (f), HV_FETCH_ISEXISTS, NULL ) )
+#define field_delete(hv, f) \
+    ( (void) field_common( (hv), (f), HV_DELETE | G_DISCARD, NULL ) )
+
+/* Set-magic on $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE, so the flag
+ * is read once per assignment (or local) rather than per field name */
+int translate_underscore_set(pTHX_ SV *sv, MAGIC *mg) {
     dMY_CXT;
-    int i;
-    SV *translate = GvSV( *MY_CXT.translate );
+    PERL_UNUSED_ARG(mg);
+
+    MY_CXT.translate = SvTRUE(sv);
+    return 0;
+}
+
+static MGVTBL translate_underscore_vtbl = {
+    NULL, translate_underscore_set, NULL, NULL, NULL
+};
+
+/* Random-replacement pick for eviction (xorshift32) */
+IV standard_case_cache_victim(pTHX) {
+    dMY_CXT;
+    U32 x = MY_CXT.cache_rand;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    MY_CXT.cache_rand = x;
+
+    return x % MY_CXT.cache_size;
+}
+
+/* Drops the cached name in slot i from %standard_case */
+void standard_case_cache_evict(pTHX_ IV i) {
+    dMY_CXT;
+    SV *key = MY_CXT.cache_keys[i];
+
+    hv_delete_ent(MY_CXT.standard_case, key, G_DISCARD, SvSHARED_HASH(key));
+    SvREFCNT_dec(key);
+    MY_CXT.cache_evictions++;
+}
+
+/* Shrinks the cache down to its limit, evicting at random */
+void standard_case_cache_trim(pTHX) {
+    dMY_CXT;
+    IV i;
+
+    while ( MY_CXT.cache_limit && MY_CXT.cache_size > MY_CXT.cache_limit ) {
+        i = standard_case_cache_victim(aTHX);
+        standard_case_cache_evict(aTHX_ i);
+        MY_CXT.cache_keys[i] = MY_CXT.cache_keys[--MY_CXT.cache_size];
+    }
+}
+
+/* Adds a %standard_case entry, making room for it if the cache is full */
+void standard_case_cache_store(pTHX_ const char *field, STRLEN len, U32 hash, const char *orig) {
+    dMY_CXT;
+    SV *key = newSVpvn_share(field, len, hash);
+    IV i;
 
-    if (!translate || field[0] == ':')
-        croak("$TRANSLATE_UNDERSCORE variable does not exist");
+    hv_store_ent( MY_CXT.standard_case, key, newSVpvn(orig, len), SvSHARED_HASH(key) );
 
-    if ( !SvOK(translate) || !SvTRUE(translate) )
+    if ( MY_CXT.cache_limit && MY_CXT.cache_size >= MY_CXT.cache_limit ) {
+        i = standard_case_cache_victim(aTHX);
+        standard_case_cache_evict(aTHX_ i);
+        MY_CXT.cache_keys[i] = key;
         return;
+    }
 
-    for ( i = 0; i < len; i++ )
-        if ( field[i] == '_' )
-            field[i] = '-';
+    if ( MY_CXT.cache_size == MY_CXT.cache_alloc ) {
+        MY_CXT.cache_alloc = MY_CXT.cache_alloc ? 2 * MY_CXT.cache_alloc : 64;
+        Renew(MY_CXT.cache_keys, MY_CXT.cache_alloc, SV *);
+    }
+    MY_CXT.cache_keys[ MY_CXT.cache_size++ ] = key;
 }
 
-void handle_standard_case(pTHX_ char *field, int len) {
+/* Standardizes field, leaving the caller's buffer alone: the lowercased
+ * name goes to out->buf, or to a mortal buffer when it doesn't fit.
+ * Names with a leading ':' are used verbatim, straight from field.
+ * Either way the name's hash is computed here, once. */
+void handle_standard_case(pTHX_ const char *field, STRLEN len, field_t *out) {
     dMY_CXT;
-    char *orig;
-    bool word_boundary;
-    int  i;
+    char *lc, *orig;
+    char orig_buf[FIELD_SCRATCH_SIZE];
+    int  known;
     SV   **standard_case_val;
 
+    out->len = len;
+    out->key = NULL;
+
     /* leading ':' means "don't standardize" */
-    if ( field[0] == ':' ) {
+    if ( len && field[0] == ':' ) {
+        out->name = field;
+        PERL_HASH(out->hash, field, len);
         return;
     }
 
-    translate_underscore(aTHX_ field, len);
-
-    /* make a copy to represent the original one and lc the original */
-    orig = (char *) alloca(len + 1);
-    for ( i = 0; i < len; i++ ) {
-        orig[i]  = field[i];
-        field[i] = tolower( field[i] );
+    if ( len <= FIELD_SCRATCH_SIZE ) {
+        lc   = out->buf;
+        orig = orig_buf;
+    } else {
+        lc   = SvPVX( sv_2mortal( newSV(2 * len) ) );
+        orig = lc + len;
     }
-    orig[len] = '\0';
 
-    standard_case_val = hv_fetch(MY_CXT.standard_case, field, len, 1);
-    if (standard_case_val == NULL)
-        croak("hv_fetch() failed. This should not happen.");
+    /* lc the field and keep the original one, with the first char after
+     * each word boundary uc'ed, for %standard_case */
+    fold_field_name(field, lc, orig, len, MY_CXT.translate);
+    out->name = lc;
+
+    /* well-known names had their hash computed along with their shared
+     * key; @header_order ones had their %standard_case entry seeded at
+     * boot, the others are spelled as first seen, as for any name */
+    known = known_header_lookup(lc, len);
+    if ( known >= 0 ) {
+        out->key  = MY_CXT.known_key[known];
+        out->hash = SvSHARED_HASH(out->key);
+        if ( known_headers[known].canonical ) {
+            MY_CXT.cache_known++;
+            return;
+        }
+    } else {
+        PERL_HASH(out->hash, lc, len);
+    }
 
     /* if we already have a value in the hash table, nothing to do */
-    if ( SvOK(*standard_case_val) )
+    standard_case_val = field_fetch(MY_CXT.standard_case, out, 0);
+    if ( standard_case_val != NULL && SvOK(*standard_case_val) ) {
+        MY_CXT.cache_hits++;
         return;
+    }
+
+    /* save result in hash table */
+    MY_CXT.cache_misses++;
+    standard_case_cache_store(aTHX_ lc, len, out->hash, orig);
+}
+
+/* Constant field names, under "use HTTP::Headers::Fast::XS ':const'",
+ * carry their standardized name as a shared key in this magic's mg_obj;
+ * mg_private says which $TRANSLATE_UNDERSCORE it was computed under */
+#define FIELD_CONST_TRANSLATE 0x01 /* computed with translation on */
+#define FIELD_CONST_ANY       0x02 /* no '_' in the name: either will do */
+#define FIELD_CONST_KNOWN     0x04 /* a known_headers[] name seeded at boot */
+
+#define FIELD_CONST_HINT "HTTP::Headers::Fast::XS/const"
+
+static MGVTBL field_const_vtbl = { NULL, NULL, NULL, NULL, NULL };
+
+/* Standardizes the field name held in sv, see handle_standard_case() */
+void standardize_field_sv(pTHX_ SV *sv, field_t *out) {
+    STRLEN     len;
+    const char *field;
+    MAGIC      *mg;
+
+    if ( SvRMAGICAL(sv)
+      && ( mg = mg_findext(sv, PERL_MAGIC_ext, &field_const_vtbl) ) != NULL ) {
+        dMY_CXT;
+
+        if ( mg->mg_private & FIELD_CONST_ANY
+          || cBOOL(mg->mg_private & FIELD_CONST_TRANSLATE) == MY_CXT.translate ) {
+            SV **standard_case_val;
+
+            out->key  = mg->mg_obj;
+            out->name = SvPVX_const(out->key);
+            out->len  = SvCUR(out->key);
+            out->hash = SvSHARED_HASH(out->key);
+
+            if ( mg->mg_private & FIELD_CONST_KNOWN ) {
+                MY_CXT.cache_known++;
+                return;
+            }
 
-    /* uc first char after word boundary */
-    word_boundary = TRUE;
-    for (i = 0; i < len; i++ ) {
-        if (word_boundary) {
-            orig[i] = toupper( orig[i] );
+            /* an evicted %standard_case entry is put back the long way */
+            standard_case_val = field_fetch(MY_CXT.standard_case, out, 0);
+            if ( out->name[0] == ':'
+              || ( standard_case_val != NULL && SvOK(*standard_case_val) ) ) {
+                MY_CXT.cache_hits++;
+                return;
+            }
         }
-        word_boundary = !isWORDCHAR( orig[i] );
     }
 
-    /* save result in hash table */
-    *standard_case_val = newSVpv( orig, len );
+    field = SvPV_const(sv, len);
+    handle_standard_case(aTHX_ field, len, out);
 }
 
-SV* get_header_value(pTHX_ HV *self, char *field, STRLEN len) {
-    SV **h;
+/* Lowercases field into out, translating '_' when asked to, without
+ * adding anything to %standard_case */
+static void lowercase_field(pTHX_ const char *field, STRLEN len, field_t *out, bool translate) {
+    dMY_CXT;
+    char *lc;
+    int  known;
 
-    /* check if field has a value */
-    if ( !hv_exists(self, field, len) )
-        return NULL;
+    lc = len <= FIELD_SCRATCH_SIZE ? out->buf : SvPVX( sv_2mortal( newSV(len) ) );
 
-    h = hv_fetch(self, field, len, 0);
-    if (h == NULL)
-        croak("hv_fetch() failed. This should not happen.");
+    fold_field_name(field, lc, NULL, len, translate);
+    out->name = lc;
+    out->len  = len;
+    out->key  = NULL;
 
-    if ( SvROK(*h) )
-        return *h;
-    else
-        return newSVsv(*h);
+    known = known_header_lookup(lc, len);
+    if ( known >= 0 ) {
+        out->key  = MY_CXT.known_key[known];
+        out->hash = SvSHARED_HASH(out->key);
+        return;
+    }
+    PERL_HASH(out->hash, lc, len);
+}
+
+/* remove_header()'s "lc $field", after the '_' translation unless the
+ * name starts with ':'. Unlike standardize_field_sv() nothing is added to
+ * %standard_case, as the name is only being removed. */
+void lowercase_field_sv(pTHX_ SV *sv, field_t *out) {
+    dMY_CXT;
+    STRLEN     len;
+    const char *field = SvPV_const(sv, len);
+
+    lowercase_field( aTHX_ field, len, out, MY_CXT.translate && !( len && field[0] == ':' ) );
+}
+
+/* The key handle_standard_case() would give field, for names that are
+ * only looked up: nothing is added to %standard_case for them */
+void field_key(pTHX_ const char *field, STRLEN len, field_t *out) {
+    dMY_CXT;
+
+    if ( len && field[0] == ':' ) {
+        out->name = field;
+        out->len  = len;
+        out->key  = NULL;
+        PERL_HASH(out->hash, field, len);
+        return;
+    }
+    lowercase_field(aTHX_ field, len, out, MY_CXT.translate);
+}
+
+#if PERL_BCDVERSION >= 0x5022000
+#  define ENTERSUB_CHECKER 1
+#endif
+
+#ifdef ENTERSUB_CHECKER
+
+/* Attaches field_const_vtbl magic to the field name argument of an
+ * entersub op, when that is a constant string */
+void field_const_mark(pTHX_ OP *entersub) {
+    OP         *aop, *field_op;
+    SV         *sv, *key;
+    field_t    f;
+    const char *name;
+    STRLEN     len;
+    U8         flags;
+    dMY_CXT;
+
+    aop = cUNOPx(entersub)->op_first;
+    if ( !OpHAS_SIBLING(aop) )
+        aop = cUNOPx(aop)->op_first;
+
+    /* pushmark, invocant, field name, ..., cv or method op */
+    if ( ( aop = OpSIBLING(aop) ) == NULL || ( field_op = OpSIBLING(aop) ) == NULL
+      || !OpHAS_SIBLING(field_op) || field_op->op_type != OP_CONST )
+        return;
+
+    sv = cSVOPx_sv(field_op);
+    if ( sv == NULL || !SvPOK(sv) || !SvREADONLY(sv) || SvUTF8(sv) || SvMAGICAL(sv) )
+        return;
+
+    name = SvPV_const(sv, len);
+    handle_standard_case(aTHX_ name, len, &f);
+
+    flags = MY_CXT.translate ? FIELD_CONST_TRANSLATE : 0;
+    if ( memchr(name, '_', len) == NULL )
+        flags |= FIELD_CONST_ANY;
+
+    if (f.key) {
+        if ( known_header_order(f.name, f.len) != KNOWN_HEADER_NO_ORDER )
+            flags |= FIELD_CONST_KNOWN;
+        key = SvREFCNT_inc_simple_NN(f.key);
+    } else {
+        key = newSVpvn_share(f.name, f.len, f.hash);
+    }
+
+    sv_magicext(sv, key, PERL_MAGIC_ext, &field_const_vtbl, NULL, 0)->mg_private = flags;
+    SvREFCNT_dec(key); /* sv_magicext() took its own reference */
+}
+
+static int hint_enabled(pTHX_ const char *key) {
+    SV *hint = cop_hints_fetch_pv(PL_curcop, key, 0, 0);
+
+    return hint != &PL_sv_placeholder && SvTRUE(hint);
+}
+
+/* Call checker for direct calls: HTTP::Headers::Fast::header($h, 'Foo') */
+static OP *field_const_call_checker(pTHX_ OP *o, GV *namegv, SV *ckobj) {
+    if ( hint_enabled(aTHX_ FIELD_CONST_HINT) )
+        field_const_mark(aTHX_ o);
+
+    return ck_entersub_args_proto_or_list(o, namegv, ckobj);
+}
+
+/* Method calls under "use HTTP::Headers::Fast::XS ':ops'" become this
+ * custom op: when the method resolves to one of our XSUBs it's called
+ * straight away, skipping pp_entersub; anything else (a subclass
+ * overriding it, the debugger) goes through pp_entersub as usual */
+#define HEADER_OPS_HINT "HTTP::Headers::Fast::XS/ops"
+
+static XOP header_method_xop;
+
+/* CvXSUB() of header, _header_get, _header_set and push_header */
+static XSUBADDR_t header_method_xsubs[4];
+
+static OP *pp_header_method(pTHX) {
+    SV  *sv = *PL_stack_sp;
+    CV  *cv;
+    I32 markix;
+    U8  gimme;
+
+    if ( SvTYPE(sv) != SVt_PVCV || !CvISXSUB((CV *) sv)
+      || PL_op->op_private & OPpENTERSUB_DB )
+        return PL_ppaddr[OP_ENTERSUB](aTHX);
+
+    cv = (CV *) sv;
+    if ( CvXSUB(cv) != header_method_xsubs[0] && CvXSUB(cv) != header_method_xsubs[1]
+      && CvXSUB(cv) != header_method_xsubs[2] && CvXSUB(cv) != header_method_xsubs[3] )
+        return PL_ppaddr[OP_ENTERSUB](aTHX);
+
+    markix = TOPMARK;
+    gimme  = GIMME_V;
+    PL_stack_sp--; /* the CV pushed by method_named */
+
+    CvXSUB(cv)(aTHX_ cv);
+
+    /* as pp_entersub does, leave exactly one value in scalar context */
+    if ( gimme == G_SCALAR ) {
+        SV **svp = PL_stack_base + markix + 1;
+
+        if ( svp != PL_stack_sp ) {
+            *svp = svp > PL_stack_sp ? &PL_sv_undef : *PL_stack_sp;
+            PL_stack_sp = svp;
+        }
+    }
+
+    return NORMAL;
+}
+
+static Perl_check_t header_next_ck_entersub;
+
+/* Method calls are never resolved at compile time, so $h->header('Foo')
+ * is recognized here, by the method name */
+static OP *header_ck_entersub(pTHX_ OP *o) {
+    OP         *cvop;
+    STRLEN     len;
+    const char *meth;
+
+    o = header_next_ck_entersub(aTHX_ o);
+
+    if ( o->op_type != OP_ENTERSUB )
+        return o;
+
+    cvop = cUNOPx(o)->op_first;
+    if ( !OpHAS_SIBLING(cvop) )
+        cvop = cUNOPx(cvop)->op_first;
+    while ( OpHAS_SIBLING(cvop) )
+        cvop = OpSIBLING(cvop);
+
+    if ( cvop->op_type != OP_METHOD_NAMED )
+        return o;
+
+    meth = SvPV_const(cMETHOPx_meth(cvop), len);
+
+    if ( ( ( len == 6  && memEQ(meth, "header", 6) )
+        || ( len == 11 && memEQ(meth, "_header_get", 11) )
+        || ( len == 11 && memEQ(meth, "push_header", 11) ) )
+      && hint_enabled(aTHX_ FIELD_CONST_HINT) )
+        field_const_mark(aTHX_ o);
+
+    if ( ( ( len == 6  && memEQ(meth, "header", 6) )
+        || ( len == 11 && memEQ(meth, "_header_get", 11) )
+        || ( len == 11 && memEQ(meth, "_header_set", 11) )
+        || ( len == 11 && memEQ(meth, "push_header", 11) ) )
+      && hint_enabled(aTHX_ HEADER_OPS_HINT) ) {
+        o->op_type   = OP_CUSTOM;
+        o->op_ppaddr = pp_header_method;
+    }
+
+    return o;
 }
 
-void set_header_value(pTHX_ HV *self, char *field, int len, SV *val) {
+#endif /* ENTERSUB_CHECKER */
+
+/* Returns the value stored for field, or NULL. The SV still belongs to
+ * the hash: callers about to replace it must hold on to it themselves. */
+SV* get_header_value(pTHX_ HV *self, field_t *f) {
+    SV **h = field_fetch(self, f, 0);
+
+    return h ? *h : NULL;
+}
+
+void set_header_value(pTHX_ HV *self, field_t *f, SV *val) {
     SV **val_0;
 
     /* if array has a single element, then store that element instead of the array */
@@ -106,19 +473,20 @@ void set_header_value(pTHX_ HV *self, char *field, int len, SV *val) {
 
         val = *val_0;
     }
-    hv_store(self, field, len, newSVsv(val), 0);
+    field_store(self, f, newSVsv(val));
 }
 
-void push_header_value(pTHX_  HV *self, char *field, STRLEN len, SV *val) {
+void push_header_value(pTHX_  HV *self, field_t *f, SV *val) {
     AV  *array;
     SV  **h, **array_elem;
     int i, top_index;
 
-    h = hv_fetch( self, field, len, 1 );
+    h = field_fetch(self, f, 1);
     if ( h == NULL )
         croak("hv_fetch() failed. This should not happen.");
 
     if ( ! SvOK(*h) ) {
+        SvREFCNT_dec(*h);
         *h = newRV_noinc( (SV *) newAV() );
     } else if ( ! SvROK(*h) || SvTYPE(SvRV(*h)) != SVt_PVAV || sv_isobject(*h) ) {
         array = newAV();
@@ -142,6 +510,66 @@ void push_header_value(pTHX_  HV *self, char *field, STRLEN len, SV *val) {
     }
 }
 
+/* Adds a field as new() would: the first value as it is, more of them
+ * turning it into an array as push_header_value() does */
+void store_field_value(pTHX_ HV *self, field_t *f, const char *value, STRLEN value_len) {
+    if ( field_exists(self, f) )
+        push_header_value(aTHX_ self, f, sv_2mortal( newSVpvn(value, value_len) ));
+    else
+        field_store(self, f, newSVpvn(value, value_len));
+}
+
+void store_field(pTHX_ HV *self, const char *name, STRLEN name_len,
+                 const char *value, STRLEN value_len) {
+    field_t f;
+
+    handle_standard_case(aTHX_ name, name_len, &f);
+    store_field_value(aTHX_ self, &f, value, value_len);
+}
+
+/* Adds the request headers in a PSGI env: HTTP_* keys, less the prefix,
+ * plus CONTENT_TYPE and CONTENT_LENGTH. The env spells '-' as '_' and
+ * uppercases everything, so names are translated whatever
+ * $TRANSLATE_UNDERSCORE says and lowercased before being title-cased.
+ * Values are copy-on-write copies of the env's. */
+void headers_from_psgi_env(pTHX_ HV *self, HV *env) {
+    HE *he;
+
+    hv_iterinit(env);
+    while ( ( he = hv_iternext(env) ) != NULL ) {
+        const char *key, *name;
+        STRLEN     len, i;
+        char       buf[FIELD_SCRATCH_SIZE], *tr;
+        field_t    f;
+        SV         *value;
+
+        key = HePV(he, len);
+        if ( len > 5 && memEQs(key, 5, "HTTP_") ) {
+            name = key + 5;
+            len -= 5;
+        } else if ( memEQs(key, len, "CONTENT_TYPE") || memEQs(key, len, "CONTENT_LENGTH") ) {
+            name = key;
+        } else {
+            continue;
+        }
+
+        value = hv_iterval(env, he);
+        SvGETMAGIC(value);
+        if ( !SvOK(value) )
+            continue;
+
+        tr = len <= sizeof(buf) ? buf : SvPVX( sv_2mortal( newSV(len) ) );
+        for ( i = 0; i < len; i++ )
+            tr[i] = name[i] == '_' ? '-' : toLOWER(name[i]);
+
+        handle_standard_case(aTHX_ tr, len, &f);
+        if ( field_exists(self, &f) )
+            push_header_value(aTHX_ self, &f, value);
+        else
+            field_store(self, &f, newSVsv_nomg(value));
+    }
+}
+
 int put_array_values_on_perl_stack(pTHX_ AV *array) {
     dSP;
     int i, count;
@@ -161,12 +589,12 @@ int put_array_values_on_perl_stack(pTHX_ AV *array) {
 }
 
 /* Returns if we store that field name or not */
-int put_header_value_on_perl_stack(pTHX_ SV *self, char *field, STRLEN len) {
+int put_header_value_on_perl_stack(pTHX_ SV *self, field_t *f) {
     dSP;
     int count;
     SV  *value;
 
-    value = get_header_value(aTHX_ (HV *) SvRV(self), field, len);
+    value = get_header_value(aTHX_ (HV *) SvRV(self), f);
 
     if (value == NULL)
         return 0;
@@ -205,180 +633,2924 @@ SV * join(pTHX_ AV *values) {
     return joined;
 }
 
-MODULE = HTTP::Headers::Fast::XS		PACKAGE = HTTP::Headers::Fast::XS
-PROTOTYPES: DISABLE
-
-BOOT:
-{
-    MY_CXT_INIT;
-    MY_CXT.standard_case = get_hv( "HTTP::Headers::Fast::standard_case", 0 );
-    MY_CXT.translate     = hv_fetch(
-        gv_stashpvn( "HTTP::Headers::Fast", 19, 0 ),
-        "TRANSLATE_UNDERSCORE",
-        20,
-        0
-    );
-}
+/* The field's value as $h->header($field) returns it in scalar context,
+ * as a new SV; NULL when the field is missing */
+SV * get_header_scalar(pTHX_ HV *self, field_t *f) {
+    SV *value = get_header_value(aTHX_ self, f);
 
-char *
-_standardize_field_name(SV *field)
-    PREINIT:
-        char   *field_name;
-        STRLEN len;
-    CODE:
-        field_name = SvPV(field, len);
-        handle_standard_case(aTHX_ field_name, len);
-        RETVAL = field_name;
-    OUTPUT: RETVAL
+    if (value == NULL)
+        return NULL;
 
-void
-push_header( SV *self, ... )
-    PREINIT:
-        char   *field;
-        int    i;
-        STRLEN len;
-    CODE:
-        if ( items % 2 == 0 )
-            croak("You must provide key/value pairs");
+    if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) )
+        return join(aTHX_ (AV *) SvRV(value));
 
-        for ( i = 1; i < items; i += 2 ) {
-            field = SvPV(ST(i), len);
-            handle_standard_case(aTHX_ field, len);
-            push_header_value(aTHX_ (HV *) SvRV(self), field, len, ST(i + 1));
-       }
+    return newSVsv(value);
+}
 
-void
-header(SV *self, ...)
-    PREINIT:
-        char   *field;
-        int    arg, count;
-        STRLEN len;
-        SV     *args[items], *value;
-        HV     *seen, *self_hash;
-    PPCODE:
-        if (items <= 1)
-            croak("Usage: $h->header($field, ...)");
+/* Deletes the fields remove_content_headers() takes from self, moving
+ * their values into removed unless that's NULL */
+void headers_remove_content(pTHX_ HV *self, HV *removed) {
+    STRLEN bucket;
+    HE     *he;
+    SV     *key, *value;
+    U32    hash;
 
-        /* check if we can skip preparing the results */
-        self_hash = (HV *) SvRV(self);
+    if ( HvARRAY(self) == NULL )
+        return;
 
-        if (items == 2) {
-            /* @old = $self->_header_get(@_) */
-            field = SvPV(ST(1), len);
-            handle_standard_case(aTHX_ field, len);
-            value = get_header_value(aTHX_ self_hash, field, len);
-        } else if (items == 3) {
-            /* @old = $self->_header_set(@_) */
-            field = SvPV(ST(1), len);
-            handle_standard_case(aTHX_ field, len);
-            value = get_header_value(aTHX_ self_hash, field, len);
+    for ( bucket = 0; bucket <= HvMAX(self); bucket++ ) {
+        he = HvARRAY(self)[bucket];
+        while ( he != NULL ) {
+            if ( HeVAL(he) == &PL_sv_placeholder || !known_header_is_content( HeKEY(he), HeKLEN(he) ) ) {
+                he = HeNEXT(he);
+                continue;
+            }
 
-            if ( value != NULL && !SvOK(ST(2)) ) {
-                hv_delete(self_hash, field, len, G_DISCARD);
+            /* deleting it changes the chain: start the bucket over */
+            key  = newSVhek( HeKEY_hek(he) );
+            hash = HeHASH(he);
+            if ( removed == NULL ) {
+                (void) hv_delete_ent(self, key, G_DISCARD, hash);
             } else {
-                set_header_value(aTHX_ self_hash, field, len, ST(2));
+                value = hv_delete_ent(self, key, 0, hash);
+                (void) hv_store_ent( removed, key, SvREFCNT_inc_simple_NN(value), hash );
             }
-        } else {
-            /* save the args from the stack since _header_push()
-             * might overwrite them with results */
-            for (arg = 1; arg < items; arg++)
-                args[arg] = ST(arg);
+            SvREFCNT_dec(key);
+            he = HvARRAY(self)[bucket];
+        }
+    }
+}
 
-            seen = newHV();
-            for (arg = 1; arg < items; arg += 2) {
-                field = SvPV(args[arg], len);
-                handle_standard_case(aTHX_ field, len); /* lc $field */
+/* A key of the object hash, as as_string() sorts them */
+typedef struct {
+    HE         *he;
+    SV         *key_sv; /* scan(): the key, for fetching its value again */
+    const char *key;
+    STRLEN     len;
+    bool       utf8;
+    int        order;
+} header_entry_t;
+
+/* _sorted_field_names(): by %header_order rank, then by key */
+static int header_entry_cmp(const void *a, const void *b) {
+    const header_entry_t *x = (const header_entry_t *) a;
+    const header_entry_t *y = (const header_entry_t *) b;
+    int cmp;
+
+    if ( x->order != y->order )
+        return x->order - y->order;
+
+    if ( x->utf8 != y->utf8 ) {
+        dTHX;
+        return x->utf8
+            ? -bytes_cmp_utf8( (const U8 *) y->key, y->len, (const U8 *) x->key, x->len )
+            :  bytes_cmp_utf8( (const U8 *) x->key, x->len, (const U8 *) y->key, y->len );
+    }
 
-                if ( !hv_exists(seen, field, len) ) {
-                    hv_store(seen, field, len, newSViv(1), 0);
+    cmp = memcmp( x->key, y->key, x->len < y->len ? x->len : y->len );
+    if (cmp)
+        return cmp;
+    return x->len < y->len ? -1 : x->len > y->len;
+}
 
-                    /* @old = $self->_header_set($field, shift) */
-                    value = get_header_value(aTHX_ self_hash, field, len);
-                    if ( value != NULL && !SvOK(args[arg + 1]) ) {
-                        hv_delete(self_hash, field, len, G_DISCARD);
-                    } else {
-                        set_header_value(aTHX_ self_hash, field, len, args[arg + 1]);
-                    }
-                } else {
-                    /* @old = $self->_header_push($field, shift) */
-                    value = get_header_value(aTHX_ self_hash, field, len);
-                    push_header_value(aTHX_ self_hash, field, len, args[arg + 1]);
-                }
-            }
-        }
+/* $standard_case{$key} || $key, for a field with that key. Once the cache
+ * has evicted anything, a name missing from %standard_case may be one of
+ * those, so it's title-cased again from the key as handle_standard_case()
+ * would have stored it: eviction only loses capitals inside words. Until
+ * then, and for keys with a leading ':' or '_', which are never
+ * standardized, the key is used as it is. Returns NULL for the key,
+ * otherwise the %standard_case value or a mortal. */
+SV * standard_case_name(pTHX_ const char *key, STRLEN len, bool utf8, U32 hash) {
+    dMY_CXT;
+    SV **svp, *name;
+
+    svp = (SV **) hv_common_key_len(
+        MY_CXT.standard_case,
+        key,
+        utf8 ? -(I32) len : (I32) len,
+        HV_FETCH_JUST_SV,
+        NULL,
+        hash
+    );
+    if ( svp != NULL && SvTRUE(*svp) )
+        return *svp;
 
-        if (GIMME_V == G_VOID)
-            XSRETURN_EMPTY;
+    if ( !MY_CXT.cache_evictions || len == 0 || key[0] == ':' || key[0] == '_' )
+        return NULL;
 
-        if (value == NULL) {
-            /* return wantarray ? () : undef */
-            if (GIMME_V == G_ARRAY)
-                XSRETURN_EMPTY;
+    name = sv_2mortal( newSV(len) );
+    fold_field_name( key, SvPVX(name), SvPVX(name), len, 0 );
+    SvPVX(name)[len] = '\0';
+    SvCUR_set(name, len);
+    SvPOK_only(name);
+    if (utf8)
+        SvUTF8_on(name);
+    return name;
+}
+
+/* A piece of serialized output */
+typedef struct {
+    const char *ptr;
+    STRLEN     len;
+    bool       utf8;
+} piece_t;
+
+/* _process_newline() on a byte string that has a "\n": trailing
+ * whitespace stripped, blank lines dropped, continuation lines indented
+ * and "\n" replaced with eol. Returns a mortal. */
+SV * process_newline(pTHX_ const char *src, STRLEN len, const char *eol, STRLEN eol_len) {
+    SV     *out;
+    char   *d;
+    STRLEN i, j;
+
+    while ( len && isSPACE(src[len - 1]) )
+        len--;
+
+    out = sv_2mortal( newSV( len * (eol_len + 1) + 1 ) );
+    SvPOK_only(out);
+    d = SvPVX(out);
+
+    for ( i = 0; i < len; i++ ) {
+        if ( src[i] != '\n' ) {
+            *d++ = src[i];
+            continue;
+        }
+
+        /* \n(\x0d?\n)+ */
+        for ( j = i + 1; j < len; ) {
+            if ( src[j] == '\n' )
+                j++;
+            else if ( src[j] == '\r' && j + 1 < len && src[j + 1] == '\n' )
+                j += 2;
             else
-                XSRETURN_UNDEF;
+                break;
         }
 
-        if (SvROK(value) && (SvTYPE(SvRV(value)) == SVt_PVAV) && !sv_isobject(value)) {
-            if (GIMME_V == G_ARRAY) {
-                /* return @old */
-                PUTBACK;
-                count = put_array_values_on_perl_stack(aTHX_ (AV *) SvRV(value));
-                SPAGAIN;
+        Copy(eol, d, eol_len, char);
+        d += eol_len;
+        if ( j < len && src[j] != ' ' && src[j] != '\t' )
+            *d++ = ' ';
+        i = j - 1;
+    }
 
-                XSRETURN(count);
-            } else {
-                /* return join( ', ', @old ) */
-                value = join(aTHX_ (AV *) SvRV(value));
-                PUSHs(sv_2mortal(value));
-                XSRETURN(1);
-            }
-        } else {
-            /* return $old[0] */
-            PUSHs(sv_2mortal(newSVsv(value)));
-            XSRETURN(1);
-        }
+    *d = '\0';
+    SvCUR_set( out, d - SvPVX(out) );
+    return out;
+}
 
-void
-_header_get( SV *self, SV *field_name, ... )
-    PREINIT:
-        bool   skip_standardize;
-        char   *field;
-        STRLEN len;
-    PPCODE:
-        field = SvPV(field_name, len);
+/* A value as _as_string() prints it */
+void header_value_piece(pTHX_ SV *value, SV *eol, piece_t *piece) {
+    piece->ptr  = SvPV_const(value, piece->len);
+    piece->utf8 = cBOOL(SvUTF8(value));
 
-        skip_standardize = (items == 3) && SvTRUE(ST(3));
-        if (!skip_standardize)
-            handle_standard_case(aTHX_ field, len);
+    if ( memchr(piece->ptr, '\n', piece->len) == NULL )
+        return;
 
-        /* we are putting the decremented(with the number of input parameters) SP back in the THX */
+    if ( piece->utf8 || SvUTF8(eol) ) {
+        /* \s is wider on character strings; let the perl version do those */
+        dSP;
+        SV *processed;
+
+        ENTER;
+        SAVETMPS;
+        PUSHMARK(SP);
+        XPUSHs(value);
+        XPUSHs(eol);
+        PUTBACK;
+        call_pv( "HTTP::Headers::Fast::_process_newline", G_SCALAR );
+        SPAGAIN;
+        processed = newSVsv( POPs );
         PUTBACK;
+        FREETMPS;
+        LEAVE;
 
-        XSRETURN( put_header_value_on_perl_stack(aTHX_ self, field, len) );
+        sv_2mortal(processed);
+        piece->ptr  = SvPV_const(processed, piece->len);
+        piece->utf8 = cBOOL(SvUTF8(processed));
+    } else {
+        STRLEN     eol_len;
+        const char *eol_str = SvPV_const(eol, eol_len);
+        SV         *processed;
 
-void
-_header_set(SV *self, SV *field_name, SV *val)
-    PREINIT:
-        char   *field;
-        int    count;
-        STRLEN len;
-    PPCODE:
-        field = SvPV(field_name, len);
+        processed   = process_newline(aTHX_ piece->ptr, piece->len, eol_str, eol_len);
+        piece->ptr  = SvPVX_const(processed);
+        piece->len  = SvCUR(processed);
+    }
+}
 
-        handle_standard_case(aTHX_ field, len);
+/* Appends self as _as_string() formats it to out: a "Field: value" line
+ * per value, each followed by eol, fields sorted as as_string() does
+ * unless sorted is false. The length is worked out first, so out grows
+ * once and everything is copied in a single pass. */
+void headers_serialize(pTHX_ HV *self, SV *eol, bool sorted, SV *out) {
+    HE             *he;
+    header_entry_t *entries;
+    piece_t        *pieces, *piece, eol_piece;
+    I32            count = 0, npieces = 0, i, j, top_index;
+    STRLEN         total = 0;
+    bool           utf8;
+    SV             *value, **svp;
+    char           *d;
+
+    if ( eol == NULL || !SvOK(eol) )
+        eol = sv_2mortal( newSVpvs("\n") );
+    eol_piece.ptr  = SvPV_const(eol, eol_piece.len);
+    eol_piece.utf8 = cBOOL(SvUTF8(eol));
+
+    entries = (header_entry_t *) SvPVX( sv_2mortal( newSV( (HvUSEDKEYS(self) + 1) * sizeof(header_entry_t) ) ) );
+
+    hv_iterinit(self);
+    while ( ( he = hv_iternext(self) ) != NULL ) {
+        header_entry_t *entry = &entries[count];
+
+        entry->key = HePV(he, entry->len);
+        if ( entry->len && entry->key[0] == '_' )
+            continue;
+
+        entry->he    = he;
+        entry->utf8  = cBOOL(HeUTF8(he));
+        entry->order = sorted && !entry->utf8
+                     ? known_header_order(entry->key, entry->len)
+                     : KNOWN_HEADER_NO_ORDER;
+        count++;
+
+        value = HeVAL(he);
+        if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) )
+            npieces += 2 * ( av_len( (AV *) SvRV(value) ) + 1 );
+        else
+            npieces += 2;
+    }
 
-        /* we are putting the decremented(with the number of input parameters) SP back in the THX */
-        PUTBACK;
+    if (sorted)
+        qsort( entries, count, sizeof(header_entry_t), header_entry_cmp );
 
-        count = put_header_value_on_perl_stack(aTHX_ self, field, len);
+    pieces = (piece_t *) SvPVX( sv_2mortal( newSV( (npieces + 1) * sizeof(piece_t) ) ) );
+    piece  = pieces;
+    utf8   = eol_piece.utf8;
 
-        /* we are setting the local SP variable to the value in THX */
-        SPAGAIN;
+    /* first pass: the name and value of every line, and their length */
+    for ( i = 0; i < count; i++ ) {
+        piece_t name;
+        he = entries[i].he;
 
-        if (!SvOK(val) && count) {
-            hv_delete((HV *) SvRV(self), field, len, G_DISCARD);
+        /* $standard_case{$key} || $key, without a leading ':' */
+        value = standard_case_name(aTHX_ entries[i].key, entries[i].len, entries[i].utf8, HeHASH(he));
+        if ( value != NULL ) {
+            name.ptr  = SvPV_const(value, name.len);
+            name.utf8 = cBOOL(SvUTF8(value));
         } else {
-            set_header_value(aTHX_ (HV *)SvRV(self), field, len, val);
+            name.ptr  = entries[i].key;
+            name.len  = entries[i].len;
+            name.utf8 = entries[i].utf8;
+        }
+        if ( name.len && name.ptr[0] == ':' ) {
+            name.ptr++;
+            name.len--;
         }
 
-        XSRETURN(count);
+        value = HeVAL(he);
+        if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) ) {
+            top_index = av_len( (AV *) SvRV(value) );
+
+            for ( j = 0; j <= top_index; j++ ) {
+                svp = av_fetch( (AV *) SvRV(value), j, 0 );
+
+                *piece = name;
+                header_value_piece(aTHX_ svp ? *svp : &PL_sv_undef, eol, piece + 1);
+                total += piece[0].len + piece[1].len;
+                utf8  |= piece[0].utf8 | piece[1].utf8;
+                piece += 2;
+            }
+        } else {
+            *piece = name;
+            header_value_piece(aTHX_ value, eol, piece + 1);
+            total += piece[0].len + piece[1].len;
+            utf8  |= piece[0].utf8 | piece[1].utf8;
+            piece += 2;
+        }
+    }
+    npieces = piece - pieces;
+    total  += ( 2 + eol_piece.len ) * ( npieces / 2 );
+
+    if ( !SvOK(out) )
+        sv_setpvs(out, "");
+    else
+        (void) SvPV_force_nolen(out);
+
+    /* one spare byte past the NUL lets perl share the buffer copy-on-write */
+    SvGROW( out, SvCUR(out) + total + 2 );
+
+    /* second pass: copy it all over */
+    if ( utf8 || SvUTF8(out) ) {
+        /* sv_catpvn_flags() upgrades whichever side needs it */
+        for ( piece = pieces; piece < pieces + npieces; piece += 2 ) {
+            sv_catpvn_flags( out, piece[0].ptr, piece[0].len, piece[0].utf8 ? SV_CATUTF8 : SV_CATBYTES );
+            sv_catpvn_flags( out, ": ", 2, SV_CATBYTES );
+            sv_catpvn_flags( out, piece[1].ptr, piece[1].len, piece[1].utf8 ? SV_CATUTF8 : SV_CATBYTES );
+            sv_catpvn_flags( out, eol_piece.ptr, eol_piece.len, eol_piece.utf8 ? SV_CATUTF8 : SV_CATBYTES );
+        }
+    } else {
+        d = SvPVX(out) + SvCUR(out);
+        for ( piece = pieces; piece < pieces + npieces; piece += 2 ) {
+            Copy(piece[0].ptr, d, piece[0].len, char);
+            d += piece[0].len;
+            *d++ = ':';
+            *d++ = ' ';
+            Copy(piece[1].ptr, d, piece[1].len, char);
+            d += piece[1].len;
+            Copy(eol_piece.ptr, d, eol_piece.len, char);
+            d += eol_piece.len;
+        }
+        *d = '\0';
+        SvCUR_set( out, d - SvPVX(out) );
+    }
+    SvSETMAGIC(out);
+}
+
+/* Objects memoize_as_string() was called on carry this magic: the last
+ * serialized form and what it was made from. Their values carry
+ * as_string_value_vtbl magic pointing back to it, whose set and free
+ * callbacks drop it, so values changed or deleted from perl are noticed;
+ * so are the XS mutators, evictions from %standard_case, which can change
+ * field names, and keys added, deleted or given another value from perl
+ * (as_string_memo_checksum()). */
+typedef struct {
+    SV     *cached;    /* last as_string() result, or NULL */
+    SV     *eol;       /* the eol it was made with, NULL for "\n" */
+    bool   sorted;
+    UV     checksum;   /* as_string_memo_checksum() at the time */
+    UV     evictions;  /* MY_CXT.cache_evictions at the time */
+    I32    refcnt;     /* one for the object, one per watched value */
+    bool   live;       /* the object still has it */
+} as_string_memo_t;
+
+void as_string_memo_clear(pTHX_ as_string_memo_t *memo) {
+    SvREFCNT_dec(memo->cached);
+    SvREFCNT_dec(memo->eol);
+    memo->cached = NULL;
+    memo->eol    = NULL;
+}
+
+void as_string_memo_release(pTHX_ as_string_memo_t *memo) {
+    if ( --memo->refcnt > 0 )
+        return;
+
+    as_string_memo_clear(aTHX_ memo);
+    Safefree(memo);
+}
+
+int as_string_memo_free(pTHX_ SV *sv, MAGIC *mg) {
+    as_string_memo_t *memo = (as_string_memo_t *) mg->mg_ptr;
+
+    PERL_UNUSED_ARG(sv);
+    memo->live = FALSE;
+    as_string_memo_release(aTHX_ memo);
+    return 0;
+}
+
+/* a value was set, or is going away */
+int as_string_value_changed(pTHX_ SV *sv, MAGIC *mg) {
+    as_string_memo_t *memo = (as_string_memo_t *) mg->mg_ptr;
+
+    PERL_UNUSED_ARG(sv);
+    if ( memo != NULL && memo->live )
+        as_string_memo_clear(aTHX_ memo);
+    return 0;
+}
+
+int as_string_value_free(pTHX_ SV *sv, MAGIC *mg) {
+    as_string_value_changed(aTHX_ sv, mg);
+    if ( mg->mg_ptr != NULL )
+        as_string_memo_release(aTHX_ (as_string_memo_t *) mg->mg_ptr);
+    return 0;
+}
+
+#ifdef USE_ITHREADS
+/* a new thread starts out with nothing memoized, and values watched by
+ * nothing until the object's new memo claims them */
+int as_string_memo_dup(pTHX_ MAGIC *mg, CLONE_PARAMS *param) {
+    as_string_memo_t *memo;
+
+    PERL_UNUSED_ARG(param);
+    Newxz(memo, 1, as_string_memo_t);
+    memo->refcnt = 1;
+    memo->live   = TRUE;
+    mg->mg_ptr   = (char *) memo;
+    return 0;
+}
+
+int as_string_value_dup(pTHX_ MAGIC *mg, CLONE_PARAMS *param) {
+    PERL_UNUSED_ARG(param);
+    mg->mg_ptr = NULL;
+    return 0;
+}
+#  define AS_STRING_DUP(f) f
+#else
+#  define AS_STRING_DUP(f) NULL
+#endif
+
+static MGVTBL as_string_memo_vtbl = {
+    NULL, NULL, NULL, NULL, as_string_memo_free, NULL, AS_STRING_DUP(as_string_memo_dup), NULL
+};
+
+static MGVTBL as_string_value_vtbl = {
+    NULL, as_string_value_changed, NULL, NULL, as_string_value_free, NULL, AS_STRING_DUP(as_string_value_dup), NULL
+};
+
+as_string_memo_t * as_string_memo(pTHX_ HV *self) {
+    MAGIC *mg;
+
+    if ( !SvRMAGICAL(self) )
+        return NULL;
+
+    mg = mg_findext( (SV *) self, PERL_MAGIC_ext, &as_string_memo_vtbl );
+    return mg ? (as_string_memo_t *) mg->mg_ptr : NULL;
+}
+
+/* Called by the XS methods that change self */
+#define as_string_memo_invalidate(self) STMT_START {          \
+    if ( SvRMAGICAL(self) ) {                                 \
+        as_string_memo_t *memo_ = as_string_memo(aTHX_ self); \
+        if (memo_)                                            \
+            as_string_memo_clear(aTHX_ memo_);                \
+    }                                                         \
+} STMT_END
+
+void as_string_memo_watch_sv(pTHX_ SV *sv, as_string_memo_t *memo) {
+    MAGIC *mg;
+
+    for ( mg = SvMAGICAL(sv) ? SvMAGIC(sv) : NULL; mg; mg = mg->mg_moremagic ) {
+        if ( mg->mg_type != PERL_MAGIC_ext || mg->mg_virtual != &as_string_value_vtbl )
+            continue;
+        if ( mg->mg_ptr == (char *) memo )
+            return;
+        if ( mg->mg_ptr == NULL ) {
+            mg->mg_ptr = (char *) memo;
+            memo->refcnt++;
+            return;
+        }
+    }
+
+    mg = sv_magicext( sv, NULL, PERL_MAGIC_ext, &as_string_value_vtbl, (const char *) memo, 0 );
+#ifdef USE_ITHREADS
+    mg->mg_flags |= MGf_DUP;
+#endif
+    memo->refcnt++;
+}
+
+/* Makes sure every value of self (and every element of array values)
+ * tells memo when it changes */
+void as_string_memo_watch(pTHX_ HV *self, as_string_memo_t *memo) {
+    HE  *he;
+    SV  *value, **svp;
+    I32 i, top_index;
+
+    hv_iterinit(self);
+    while ( ( he = hv_iternext(self) ) != NULL ) {
+        value = HeVAL(he);
+        as_string_memo_watch_sv(aTHX_ value, memo);
+
+        if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) ) {
+            top_index = av_len( (AV *) SvRV(value) );
+            for ( i = 0; i <= top_index; i++ ) {
+                if ( ( svp = av_fetch( (AV *) SvRV(value), i, 0 ) ) != NULL )
+                    as_string_memo_watch_sv(aTHX_ *svp, memo);
+            }
+        }
+    }
+}
+
+/* A checksum of self's key set and of which SVs hold its values, array
+ * elements included. A value SV deleted while something else still holds
+ * it never tells the memo, and neither does an array being pushed onto;
+ * the next as_string() sees the keys or SVs differ. */
+static UV as_string_memo_checksum(HV *self) {
+    HE      **array = HvARRAY(self), *he, **end;
+    SV      *value, **elements;
+    UV      sum = HvTOTALKEYS(self), mix;
+    SSize_t i;
+
+    if ( array == NULL )
+        return sum;
+
+    for ( end = array + HvMAX(self) + 1; array < end; array++ ) {
+        for ( he = *array; he != NULL; he = HeNEXT(he) ) {
+            value = HeVAL(he);
+            if ( value == &PL_sv_placeholder )
+                continue;
+
+            mix = HeHASH(he) ^ PTR2UV(value);
+            if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !SvMAGICAL(SvRV(value)) ) {
+                elements = AvARRAY( (AV *) SvRV(value) );
+                for ( i = 0; i <= AvFILLp( (AV *) SvRV(value) ); i++ )
+                    mix = mix * 31 + PTR2UV(elements[i]);
+                mix += AvFILLp( (AV *) SvRV(value) );
+            }
+            /* order-independent, as hash order may change */
+            sum += mix * 2654435761U;
+        }
+    }
+    return sum;
+}
+
+/* Returns self serialized: the memoized copy when self is memoized and
+ * nothing changed since, or a fresh one, memoized when self is. The SV
+ * belongs to the memo when self is memoized, and is a mortal otherwise. */
+SV * headers_as_string(pTHX_ HV *self, SV *eol, bool sorted) {
+    dMY_CXT;
+    as_string_memo_t *memo = as_string_memo(aTHX_ self);
+    SV               *out;
+
+    if ( eol != NULL && !SvOK(eol) )
+        eol = NULL;
+
+    if ( memo == NULL ) {
+        out = sv_2mortal( newSVpvs("") );
+        headers_serialize(aTHX_ self, eol, sorted, out);
+        return out;
+    }
+
+    if ( memo->cached != NULL
+      && memo->sorted == sorted
+      && memo->evictions == MY_CXT.cache_evictions
+      && memo->checksum == as_string_memo_checksum(self)
+      && ( eol == NULL ? memo->eol == NULL : memo->eol != NULL && sv_eq(memo->eol, eol) ) )
+        return memo->cached;
+
+    as_string_memo_clear(aTHX_ memo);
+
+    out = newSVpvs("");
+    headers_serialize(aTHX_ self, eol, sorted, out);
+    as_string_memo_watch(aTHX_ self, memo);
+
+    memo->cached    = out;
+    memo->eol       = eol ? newSVsv(eol) : NULL;
+    memo->sorted    = sorted;
+    memo->checksum  = as_string_memo_checksum(self);
+    memo->evictions = MY_CXT.cache_evictions;
+    return out;
+}
+
+#ifndef SV_COW_OTHER_PVS
+#  define SV_COW_OTHER_PVS 0
+#endif
+
+/* Returns what headers_as_string() gave as a new SV: a fresh (mortal)
+ * string is simply ours, a memoized one is shared copy-on-write */
+SV * as_string_result(pTHX_ SV *out) {
+    SV *copy;
+
+    if ( SvTEMP(out) )
+        return SvREFCNT_inc_simple_NN(out);
+
+    copy = newSV(0);
+    sv_setsv_flags( copy, out, SV_NOSTEAL | SV_COW_SHARED_HASH_KEYS | SV_COW_OTHER_PVS );
+    return copy;
+}
+
+/* Whether sv's only magic is the as_string_value_vtbl kind, which
+ * memoize_as_string() adds and copies don't need */
+static bool clone_memo_magic_only(SV *sv) {
+    MAGIC *mg;
+
+    for ( mg = SvMAGIC(sv); mg; mg = mg->mg_moremagic )
+        if ( mg->mg_type != PERL_MAGIC_ext || mg->mg_virtual != &as_string_value_vtbl )
+            return FALSE;
+    return TRUE;
+}
+
+/* Values clone() copies itself: plain strings and numbers */
+#define clone_plain(sv)                                                  \
+    ( SvTYPE(sv) <= SVt_PVMG && !SvROK(sv) && !SvOBJECT(sv)              \
+      && ( !SvMAGICAL(sv) || clone_memo_magic_only(sv) ) )
+
+/* A copy-on-write copy of a plain value */
+static SV * clone_value(pTHX_ SV *value) {
+    SV *copy = newSV(0);
+
+    sv_setsv_flags( copy, value, SV_NOSTEAL | SV_COW_SHARED_HASH_KEYS | SV_COW_OTHER_PVS );
+    return copy;
+}
+
+/* Copies self's fields into copy, which is sized for them, as
+ * push_header_value() writes them: plain values and unblessed arrays of
+ * them. Returns FALSE on anything else, for dclone() to deal with. */
+bool headers_clone(pTHX_ HV *self, HV *copy) {
+    STRLEN  bucket;
+    HE      *he;
+    SV      *value, *cloned, **elements;
+    AV      *values, *cloned_values;
+    SSize_t i, top;
+
+    if ( HvARRAY(self) == NULL )
+        return TRUE;
+
+    for ( bucket = 0; bucket <= HvMAX(self); bucket++ ) {
+        for ( he = HvARRAY(self)[bucket]; he != NULL; he = HeNEXT(he) ) {
+            value = HeVAL(he);
+            if ( value == &PL_sv_placeholder )
+                continue;
+
+            if ( clone_plain(value) ) {
+                cloned = clone_value(aTHX_ value);
+            } else if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV
+                     && !SvOBJECT(SvRV(value)) && !SvMAGICAL(SvRV(value)) ) {
+                values   = (AV *) SvRV(value);
+                elements = AvARRAY(values);
+                top      = AvFILLp(values);
+                for ( i = 0; i <= top; i++ )
+                    if ( elements[i] != NULL && !clone_plain(elements[i]) )
+                        return FALSE;
+
+                cloned_values = newAV();
+                av_extend(cloned_values, top);
+                for ( i = 0; i <= top; i++ )
+                    AvARRAY(cloned_values)[i] = elements[i] ? clone_value(aTHX_ elements[i]) : newSV(0);
+                AvFILLp(cloned_values) = top;
+                cloned = newRV_noinc( (SV *) cloned_values );
+            } else {
+                return FALSE;
+            }
+
+            /* the key's hash is known, and it's shared already */
+            (void) hv_common_key_len(
+                copy,
+                HeKEY(he),
+                HeKUTF8(he) ? -(I32) HeKLEN(he) : (I32) HeKLEN(he),
+                HV_FETCH_ISSTORE | HV_FETCH_JUST_SV,
+                cloned,
+                HeHASH(he)
+            );
+        }
+    }
+    return TRUE;
+}
+
+/* Storable::dclone(self), loading Storable first if need be */
+SV * headers_dclone(pTHX_ SV *self) {
+    dSP;
+    SV *copy;
+
+    if ( get_cv("Storable::dclone", 0) == NULL ) {
+        load_module( PERL_LOADMOD_NOIMPORT, newSVpvs("Storable"), NULL );
+        SPAGAIN;
+    }
+
+    ENTER;
+    SAVETMPS;
+    PUSHMARK(SP);
+    XPUSHs(self);
+    PUTBACK;
+    call_pv( "Storable::dclone", G_SCALAR );
+    SPAGAIN;
+    copy = POPs;
+    SvREFCNT_inc_simple_void_NN(copy);
+    PUTBACK;
+    FREETMPS;
+    LEAVE;
+
+    return copy;
+}
+
+/* Points args, a scan() callback's @_ that the callback may have reified
+ * or shifted, at name and value, as pp_sort does for ($$) subs */
+static void scan_set_args(pTHX_ AV *args, SV *name, SV *value) {
+    SV **ary;
+
+    if ( AvREAL(args) ) {
+        av_clear(args);
+        AvREIFY_only(args);
+    }
+
+    ary = AvALLOC(args);
+    if ( AvARRAY(args) != ary ) {
+        AvMAX(args)  += AvARRAY(args) - ary;
+        AvARRAY(args) = ary;
+    }
+    if ( AvMAX(args) < 1 )
+        av_extend(args, 1);
+
+    AvARRAY(args)[0] = name;
+    AvARRAY(args)[1] = value;
+    AvFILLp(args)    = 1;
+}
+
+/* scan(): calls callback with the name ($standard_case{$key} || $key) and
+ * each value of every field, fields in _sorted_field_names() order and
+ * arrays expanded as put_array_values_on_perl_stack() does. Values are
+ * fetched as each field comes up, so changes the callback makes show,
+ * and array values are passed as aliases, scalars as copies, as the perl
+ * version does. A plain perl sub is called through MULTICALL, anything
+ * else with call_sv() in a scope kept across the calls. */
+void headers_scan(pTHX_ HV *self, SV *callback) {
+    dSP;
+    header_entry_t *entries;
+    I32            count = 0, i, j;
+    HE             *he;
+    AV             *hold;
+#ifdef PUSH_MULTICALL
+    CV             *sub_cv = NULL;
+    AV             *args;
+    dMULTICALL;
+    U8             gimme = G_VOID;
+#endif
+
+    ENTER;
+
+    /* the keys as they are now, sorted; entries[].he isn't used */
+    entries = (header_entry_t *) SvPVX( sv_2mortal( newSV( (HvUSEDKEYS(self) + 1) * sizeof(header_entry_t) ) ) );
+    hv_iterinit(self);
+    while ( ( he = hv_iternext(self) ) != NULL ) {
+        header_entry_t *entry = &entries[count];
+
+        entry->key_sv = hv_iterkeysv(he);
+        entry->key    = SvPV_const(entry->key_sv, entry->len);
+        if ( entry->len && entry->key[0] == '_' )
+            continue;
+
+        /* a key SV may belong to its HE, which the callback could delete */
+        SvREFCNT_inc_simple_void_NN( sv_2mortal(entry->key_sv) );
+        entry->utf8  = cBOOL(SvUTF8(entry->key_sv));
+        entry->order = entry->utf8 ? KNOWN_HEADER_NO_ORDER : known_header_order(entry->key, entry->len);
+        count++;
+    }
+    qsort( entries, count, sizeof(header_entry_t), header_entry_cmp );
+
+    /* owns the name and value of the current call: a MULTICALL callback
+     * frees any mortal made since it started */
+    hold = (AV *) sv_2mortal( (SV *) newAV() );
+    av_extend(hold, 1);
+
+#ifdef PUSH_MULTICALL
+    if ( SvROK(callback) && SvTYPE(SvRV(callback)) == SVt_PVCV && !CvISXSUB( (CV *) SvRV(callback) ) ) {
+        sub_cv = (CV *) SvRV(callback);
+        args   = newAV();
+        AvREIFY_only(args);
+        SAVEGENERICSV( GvAV(PL_defgv) );
+        GvAV(PL_defgv) = args;
+        PUSH_MULTICALL(sub_cv);
+    }
+#endif
+    SAVETMPS;
+
+    for ( i = 0; i < count; i++ ) {
+        SV *name, *value;
+        AV *array = NULL;
+
+        name = standard_case_name(aTHX_ entries[i].key, entries[i].len, entries[i].utf8, 0);
+        name = newSVsv( name ? name : entries[i].key_sv );
+        av_store(hold, 0, name);
+
+        /* a field deleted by now is passed as undef, as in the perl version */
+        he    = hv_fetch_ent(self, entries[i].key_sv, 0, 0);
+        value = he ? HeVAL(he) : &PL_sv_undef;
+        if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) ) {
+            /* held, so the array outlives the field if the callback drops it */
+            array = (AV *) SvRV(value);
+            av_store( hold, 1, newRV_inc( (SV *) array ) );
+        } else {
+            value = newSVsv(value);
+            av_store(hold, 1, value);
+        }
+
+        /* the array's length is checked on every value, as foreach does */
+        for ( j = 0; array ? j <= av_len(array) : j == 0; j++ ) {
+            if (array) {
+                SV **elem = av_fetch(array, j, 0);
+
+                value = elem ? *elem : &PL_sv_undef;
+            }
+
+#ifdef PUSH_MULTICALL
+            if (sub_cv) {
+                scan_set_args(aTHX_ args, name, value);
+                MULTICALL;
+                continue;
+            }
+#endif
+            PUSHMARK(SP);
+            EXTEND(SP, 2);
+            PUSHs(name);
+            PUSHs(value);
+            PUTBACK;
+            call_sv(callback, G_VOID);
+            SPAGAIN;
+            FREETMPS;
+        }
+    }
+
+    FREETMPS;
+#ifdef PUSH_MULTICALL
+    if (sub_cv)
+        POP_MULTICALL;
+#endif
+    LEAVE;
+}
+
+/* First hpack_static[] index (1-based) of each known_headers[] name, or
+ * 0; filled in at BOOT, read-only after that */
+static U8 hpack_known_static[KNOWN_HEADER_COUNT];
+
+static void hpack_init(void) {
+    int i, k;
+
+    for ( i = HPACK_STATIC_COUNT - 1; i >= 0; i-- ) {
+        k = known_header_lookup( hpack_static[i].name, hpack_static[i].name_len );
+        if ( k >= 0 )
+            hpack_known_static[k] = (U8) ( i + 1 );
+    }
+}
+
+/* The pseudo-header fields to_hpack() sends as such, ahead of the rest */
+static const char *const hpack_pseudo[] = {
+    ":authority", ":method", ":path", ":scheme", ":status", ":protocol", NULL
+};
+
+/* Connection-specific fields, which HTTP/2 forbids (RFC 9113, 8.2.2) */
+static const char *const hpack_forbidden[] = {
+    "connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade", NULL
+};
+
+static bool hpack_name_in(const char *name, STRLEN len, const char *const *list) {
+    for ( ; *list; list++ )
+        if ( strlen(*list) == len && memEQ(*list, name, len) )
+            return TRUE;
+    return FALSE;
+}
+
+/* First hpack_static[] index of a lowercase name, or 0 */
+static int hpack_static_name(const char *name, STRLEN len) {
+    int i;
+
+    if ( len && name[0] == ':' ) {
+        for ( i = 0; i < HPACK_STATIC_COUNT && hpack_static[i].name[0] == ':'; i++ )
+            if ( hpack_static[i].name_len == len && memEQ(hpack_static[i].name, name, len) )
+                return i + 1;
+        return 0;
+    }
+
+    i = known_header_lookup(name, len);
+    return i < 0 ? 0 : hpack_known_static[i];
+}
+
+#define HPACK_CLASS "HTTP::Headers::Fast::XS::HPACK"
+
+hpack_table_t * hpack_context(pTHX_ SV *ctx) {
+    if ( !SvROK(ctx) || !sv_derived_from(ctx, HPACK_CLASS) )
+        croak("Not an %s object", HPACK_CLASS);
+    return INT2PTR( hpack_table_t *, SvIV(SvRV(ctx)) );
+}
+
+/* Appends a string literal, Huffman coded when that's shorter. Its length
+ * has an n bit prefix, the H flag just above it and first's bits above
+ * that; HPACK strings all have n = 7 and first = 0. */
+static U8 * hpack_put_string(U8 *d, U8 first, int n, const char *s, STRLEN len) {
+    STRLEN huffman_len = hpack_huffman_size( (const U8 *) s, len );
+
+    if ( huffman_len < len ) {
+        d += hpack_put_int(d, first | ( 1 << n ), n, huffman_len);
+        d += hpack_huffman_encode( (const U8 *) s, len, d );
+    } else {
+        d += hpack_put_int(d, first, n, len);
+        Copy(s, d, len, char);
+        d += len;
+    }
+    return d;
+}
+
+/* Appends one field to out. Without a table (t is NULL) only the static
+ * table is used and nothing is indexed. */
+void hpack_encode_field(pTHX_ hpack_table_t *t, SV *out, const char *name, STRLEN name_len,
+                        int static_name, const char *value, STRLEN value_len) {
+    U32  index = 0, name_index = static_name;
+    bool sensitive;
+    U8   *d;
+    int  i;
+
+    /* RFC 7541, 7.1.3: keep credentials out of any table */
+    sensitive = ( name_len == 13 && memEQ(name, "authorization", 13) )
+             || ( name_len == 19 && memEQ(name, "proxy-authorization", 19) );
+
+    for ( i = static_name; i && i <= HPACK_STATIC_COUNT; i++ ) {
+        const hpack_static_t *s = &hpack_static[i - 1];
+
+        if ( s->name_len != name_len || memNE(s->name, name, name_len) )
+            break;
+        if ( s->value_len == value_len && memEQ(s->value, value, value_len) ) {
+            index = i;
+            break;
+        }
+    }
+
+    if ( !index && t != NULL ) {
+        U32 dynamic_name;
+
+        index = hpack_table_find(t, name, name_len, value, value_len, &dynamic_name);
+        if (index)
+            index += HPACK_STATIC_COUNT;
+        else if ( !name_index && dynamic_name )
+            name_index = dynamic_name + HPACK_STATIC_COUNT;
+    }
+
+    /* worst case: two 11 byte integers and both strings raw */
+    d = (U8 *) SvGROW( out, SvCUR(out) + 2 * 11 + name_len + 11 + value_len + 1 ) + SvCUR(out);
+
+    if ( index && !sensitive ) {
+        d += hpack_put_int(d, 0x80, 7, index);
+    } else {
+        if (sensitive)
+            d += hpack_put_int(d, 0x10, 4, name_index);
+        else if ( t == NULL || HPACK_ENTRY_OVERHEAD + name_len + value_len > t->max_size )
+            d += hpack_put_int(d, 0x00, 4, name_index);
+        else {
+            d += hpack_put_int(d, 0x40, 6, name_index);
+            hpack_table_add(t, name, name_len, value, value_len);
+        }
+
+        if ( !name_index )
+            d = hpack_put_string(d, 0x00, 7, name, name_len);
+        d = hpack_put_string(d, 0x00, 7, value, value_len);
+    }
+
+    *d = '\0';
+    SvCUR_set( out, (char *) d - SvPVX(out) );
+}
+
+/* First qpack_static[] index of a lowercase name, or -1 */
+static int qpack_static_name(const char *name, STRLEN len) {
+    int lo = 0, hi = QPACK_STATIC_NAMES - 1;
+
+    while ( lo <= hi ) {
+        int                  mid = ( lo + hi ) / 2, cmp;
+        const hpack_static_t *s  = &qpack_static[ qpack_static_names[mid] ];
+
+        cmp = memcmp( s->name, name, s->name_len < len ? s->name_len : len );
+        if ( cmp == 0 )
+            cmp = s->name_len < len ? -1 : s->name_len > len;
+        if ( cmp == 0 )
+            return qpack_static_names[mid];
+
+        if ( cmp < 0 )
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return -1;
+}
+
+/* Appends one field as a QPACK field line referring to the static table
+ * only (RFC 9204, 4.5) */
+void qpack_encode_field(pTHX_ SV *out, const char *name, STRLEN name_len,
+                        int static_name, const char *value, STRLEN value_len) {
+    bool sensitive;
+    U8   *d;
+    int  i;
+
+    sensitive = ( name_len == 13 && memEQ(name, "authorization", 13) )
+             || ( name_len == 19 && memEQ(name, "proxy-authorization", 19) );
+
+    d = (U8 *) SvGROW( out, SvCUR(out) + 2 * 11 + name_len + 11 + value_len + 1 ) + SvCUR(out);
+
+    for ( i = static_name; i >= 0; i = qpack_static_next[i] ) {
+        const hpack_static_t *s = &qpack_static[i];
+
+        if ( s->value_len == value_len && memEQ(s->value, value, value_len) )
+            break;
+    }
+
+    if ( i >= 0 && !sensitive ) {
+        /* indexed field line, static: 1 T=1 index */
+        d += hpack_put_int(d, 0xc0, 6, i);
+    } else {
+        if ( static_name >= 0 ) {
+            /* literal with name reference, static: 0 1 N T=1 index */
+            d += hpack_put_int(d, sensitive ? 0x70 : 0x50, 4, static_name);
+        } else {
+            /* literal with literal name: 0 0 1 N H length */
+            d = hpack_put_string(d, sensitive ? 0x30 : 0x20, 3, name, name_len);
+        }
+        d = hpack_put_string(d, 0x00, 7, value, value_len);
+    }
+
+    *d = '\0';
+    SvCUR_set( out, (char *) d - SvPVX(out) );
+}
+
+/* Encodes every value of one object key */
+void hpack_encode_entry(pTHX_ hpack_table_t *t, bool qpack, SV *out, HE *he) {
+    const char *key, *name;
+    STRLEN     len, value_len;
+    char       buf[FIELD_SCRATCH_SIZE];
+    SV         *value, **values;
+    I32        i, count;
+    int        static_name;
+
+    key = HePV(he, len);
+    if ( len && key[0] == ':' && !hpack_name_in(key, len, hpack_pseudo) ) {
+        key++;
+        len--;
+    }
+
+    /* field names go out lowercase */
+    name = key;
+    for ( i = 0; i < (I32) len; i++ ) {
+        if ( isUPPER(key[i]) ) {
+            char *lc = len <= sizeof(buf) ? buf : SvPVX( sv_2mortal( newSV(len) ) );
+
+            fold_field_name(key, lc, NULL, len, 0);
+            name = lc;
+            break;
+        }
+    }
+
+    if ( hpack_name_in(name, len, hpack_forbidden) )
+        return;
+
+    static_name = qpack ? qpack_static_name(name, len) : hpack_static_name(name, len);
+
+    value = HeVAL(he);
+    values = NULL;
+    count  = 1;
+    if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) )
+        count = av_len( (AV *) SvRV(value) ) + 1;
+    else
+        values = &value;
+
+    for ( i = 0; i < count; i++ ) {
+        const char *v = "";
+        SV         **svp = values ? values : av_fetch( (AV *) SvRV(value), i, 0 );
+
+        value_len = 0;
+        if ( svp != NULL && SvOK(*svp) ) {
+            v = SvPVbyte(*svp, value_len);
+
+            /* HTTP/2 has no line folding: unfold as as_string() would
+             * with an empty eol */
+            if ( memchr(v, '\n', value_len) ) {
+                SV *unfolded = process_newline(aTHX_ v, value_len, "", 0);
+                v = SvPV_const(unfolded, value_len);
+            }
+            if ( memchr(v, '\r', value_len) || memchr(v, '\0', value_len) )
+                croak("Value of field '%" SVf "' has a CR or NUL, which %s can't carry",
+                      SVfARG( sv_2mortal( newSVpvn(name, len) ) ), qpack ? "QPACK" : "HPACK");
+        }
+
+        if (qpack)
+            qpack_encode_field(aTHX_ out, name, len, static_name, v, value_len);
+        else
+            hpack_encode_field(aTHX_ t, out, name, len, static_name, v, value_len);
+    }
+}
+
+/* Appends self as an HPACK header block to out, pseudo-header fields
+ * first, indexing through t's dynamic table when t isn't NULL; or, with
+ * qpack, as a QPACK field section using the static table only */
+void headers_to_hpack(pTHX_ HV *self, hpack_table_t *t, bool qpack, SV *out) {
+    HE  *he;
+    int pass;
+
+    if (qpack) {
+        /* Required Insert Count and Delta Base: no dynamic table */
+        sv_catpvn(out, "\0\0", 2);
+    } else if ( t != NULL && t->update ) {
+        /* RFC 7541, 4.2: the smallest size since the last block, then
+         * the current one when it went up again */
+        U8 *d = (U8 *) SvGROW( out, SvCUR(out) + 2 * 11 + 1 ) + SvCUR(out);
+
+        if ( t->update_min < t->max_size )
+            d += hpack_put_int(d, 0x20, 5, t->update_min);
+        d += hpack_put_int(d, 0x20, 5, t->max_size);
+        *d = '\0';
+        SvCUR_set( out, (char *) d - SvPVX(out) );
+
+        t->update     = FALSE;
+        t->update_min = t->max_size;
+    }
+
+    for ( pass = 0; pass < 2; pass++ ) {
+        hv_iterinit(self);
+        while ( ( he = hv_iternext(self) ) != NULL ) {
+            STRLEN     len;
+            const char *key = HePV(he, len);
+
+            if ( !len || key[0] == '_' )
+                continue;
+            if ( ( pass == 0 ) != hpack_name_in(key, len, hpack_pseudo) )
+                continue;
+
+            hpack_encode_entry(aTHX_ t, qpack, out, he);
+        }
+    }
+}
+
+#define HPACK_MALFORMED "Malformed HPACK header block: "
+#define QPACK_MALFORMED "Malformed QPACK field section: "
+
+/* Reads the string literal at *s, Huffman decoding it into scratch when
+ * it's coded; its length has an n bit prefix, with the H flag above it.
+ * malformed starts the message of the croak when it's bad. */
+static const char * hpack_get_string(pTHX_ const U8 **s, const U8 *end, int n_bits,
+                                     SV *scratch, STRLEN *len, const char *malformed) {
+    const U8 *str;
+    UV       n;
+    STRLEN   used = hpack_get_int(*s, end, n_bits, &n);
+    SSize_t  decoded;
+    char     *buf;
+
+    if ( !used || n > (UV) ( end - *s - used ) )
+        croak("%struncated string", malformed);
+
+    str = *s + used;
+    *s  = str + n;
+    if ( !( str[-(SSize_t) used] & ( 1 << n_bits ) ) ) {
+        *len = n;
+        return (const char *) str;
+    }
+
+    buf     = SvGROW( scratch, n * 8 / 5 + 1 );
+    decoded = hpack_huffman_decode(str, n, (U8 *) buf);
+    if ( decoded < 0 )
+        croak("%sbad Huffman code", malformed);
+
+    *len = decoded;
+    return buf;
+}
+
+/* Decodes the header block at s into self through t's dynamic table.
+ * Fields are counted as SETTINGS_MAX_HEADER_LIST_SIZE counts them; past
+ * t->max_list_size the rest are decoded without being stored, so the
+ * table stays in step with the peer's, and then it croaks. */
+void headers_from_hpack(pTHX_ HV *self, hpack_table_t *t, const U8 *s, STRLEN len) {
+    const U8 *end = s + len;
+    SV       *name_buf  = sv_2mortal( newSV(FIELD_SCRATCH_SIZE) );
+    SV       *value_buf = sv_2mortal( newSV(FIELD_SCRATCH_SIZE) );
+    bool     fields = FALSE;
+    UV       list_size = 0;
+
+    while ( s < end ) {
+        const char *name, *value;
+        STRLEN     name_len, value_len, used;
+        UV         index;
+        int        prefix;
+
+        if ( *s & 0x80 )
+            prefix = 7; /* indexed */
+        else if ( *s & 0x40 )
+            prefix = 6; /* literal, added to the table */
+        else if ( *s & 0x20 )
+            prefix = 5; /* table size update */
+        else
+            prefix = 4; /* literal, never or not indexed */
+
+        used = hpack_get_int(s, end, prefix, &index);
+        if ( !used )
+            croak(HPACK_MALFORMED "truncated or oversized integer");
+
+        if ( prefix == 5 ) {
+            if (fields)
+                croak(HPACK_MALFORMED "table size update after a header field");
+            if ( index > t->settings_size )
+                croak(HPACK_MALFORMED "table size %" UVuf " over the %" UVuf " limit", index, t->settings_size);
+
+            hpack_table_resize(t, index);
+            s += used;
+            continue;
+        }
+
+        fields = TRUE;
+        s     += used;
+
+        if ( index && !hpack_lookup(t, index, &name, &name_len, &value, &value_len) )
+            croak(HPACK_MALFORMED "no entry %" UVuf " in the table", index);
+
+        if ( prefix != 7 ) {
+            if ( !index )
+                name = hpack_get_string(aTHX_ &s, end, 7, name_buf, &name_len, HPACK_MALFORMED);
+            value = hpack_get_string(aTHX_ &s, end, 7, value_buf, &value_len, HPACK_MALFORMED);
+        } else if ( !index ) {
+            croak(HPACK_MALFORMED "no entry 0 in the table");
+        }
+
+        list_size += name_len + value_len + HPACK_ENTRY_OVERHEAD;
+        if ( !t->max_list_size || list_size <= t->max_list_size )
+            store_field(aTHX_ self, name, name_len, value, value_len);
+        if ( prefix == 6 )
+            hpack_table_add(t, name, name_len, value, value_len);
+    }
+
+    if ( t->max_list_size && list_size > t->max_list_size )
+        croak("HPACK header list over the %" UVuf " byte limit", t->max_list_size);
+}
+
+/* Decodes the QPACK field section at s into self; only the static table
+ * is supported, so any reference to the dynamic table croaks, and so does
+ * going over max_list_size (SETTINGS_MAX_FIELD_SECTION_SIZE, 0 for none) */
+void headers_from_qpack(pTHX_ HV *self, const U8 *s, STRLEN len, UV max_list_size) {
+    const U8 *end = s + len;
+    SV       *name_buf  = sv_2mortal( newSV(FIELD_SCRATCH_SIZE) );
+    SV       *value_buf = sv_2mortal( newSV(FIELD_SCRATCH_SIZE) );
+    UV       index, list_size = 0;
+    STRLEN   used;
+
+    /* Required Insert Count, then Delta Base */
+    if ( !( used = hpack_get_int(s, end, 8, &index) ) )
+        croak(QPACK_MALFORMED "truncated or oversized integer");
+    if (index)
+        croak(QPACK_MALFORMED "dynamic table references are not supported");
+    s += used;
+    if ( !( used = hpack_get_int(s, end, 7, &index) ) )
+        croak(QPACK_MALFORMED "truncated or oversized integer");
+    s += used;
+
+    while ( s < end ) {
+        const char *name, *value;
+        STRLEN     name_len, value_len;
+        int        prefix;
+        bool       dynamic;
+
+        if ( *s & 0x80 ) {
+            prefix  = 6; /* indexed field line */
+            dynamic = !( *s & 0x40 );
+        } else if ( *s & 0x40 ) {
+            prefix  = 4; /* literal with name reference */
+            dynamic = !( *s & 0x10 );
+        } else if ( *s & 0x20 ) {
+            prefix  = 0; /* literal with literal name */
+            dynamic = FALSE;
+        } else {
+            /* post-base index or name reference */
+            croak(QPACK_MALFORMED "dynamic table references are not supported");
+        }
+
+        if (dynamic)
+            croak(QPACK_MALFORMED "dynamic table references are not supported");
+
+        if (prefix) {
+            if ( !( used = hpack_get_int(s, end, prefix, &index) ) )
+                croak(QPACK_MALFORMED "truncated or oversized integer");
+            if ( index >= QPACK_STATIC_COUNT )
+                croak(QPACK_MALFORMED "no entry %" UVuf " in the static table", index);
+            s += used;
+
+            name      = qpack_static[index].name;
+            name_len  = qpack_static[index].name_len;
+            value     = qpack_static[index].value;
+            value_len = qpack_static[index].value_len;
+        } else {
+            name = hpack_get_string(aTHX_ &s, end, 3, name_buf, &name_len, QPACK_MALFORMED);
+        }
+
+        if ( prefix != 6 )
+            value = hpack_get_string(aTHX_ &s, end, 7, value_buf, &value_len, QPACK_MALFORMED);
+
+        list_size += name_len + value_len + HPACK_ENTRY_OVERHEAD;
+        if ( max_list_size && list_size > max_list_size )
+            croak("QPACK field section over the %" UVuf " byte limit", max_list_size);
+
+        store_field(aTHX_ self, name, name_len, value, value_len);
+    }
+}
+
+static void hpack_table_free_scoped(pTHX_ void *t) {
+    hpack_table_free( (hpack_table_t *) t );
+}
+
+#define PARSE_MALFORMED "Malformed header block: "
+
+/* Croaks about the line at line, quoting (the start of) it */
+static void parse_croak(pTHX_ const char *why, const char *line, const char *end) {
+    const char *eol = line;
+
+    while ( eol < end && eol - line < 40 && *eol != '\r' && *eol != '\n' )
+        eol++;
+    croak(PARSE_MALFORMED "%s in line '%" SVf "'", why, SVfARG( sv_2mortal( newSVpvn(line, eol - line) ) ));
+}
+
+
+/* A field of a lazy object, still in the buffer it was parsed from */
+typedef struct {
+    STRLEN name_off;
+    STRLEN name_len;
+    STRLEN value_off;
+    STRLEN value_len;
+    bool   folded;  /* the value has continuation lines to unfold */
+    bool   done;    /* stored in the hash already */
+} lazy_field_t;
+
+/* What parse_lazy() objects carry in their lazy_vtbl magic */
+typedef struct {
+    SV           *raw;    /* copy-on-write copy of the parsed buffer */
+    lazy_field_t *fields;
+    UV           count;
+    UV           alloc;
+    UV           left;    /* fields not done yet */
+    HV           *stash;  /* the class parse_lazy() was called on */
+} lazy_t;
+
+/* Where parse_lines() puts what it parsed */
+typedef struct {
+    HV   *headers;    /* the object's hash */
+    lazy_t *lazy;     /* when set, fields are recorded there instead */
+    HV   *only;       /* when set, fields not in it are skipped */
+    SV   *folded;     /* scratch for unfolding values, NULL for a mortal one */
+    UV   fields;      /* fields stored so far */
+    UV   max_fields;  /* croak past this many, 0 for no limit */
+    bool done;        /* the block is over */
+} parse_t;
+
+/* Appends the value at v, which has continuation lines, to out with its
+ * lines joined by "\n", less their trailing whitespace and line ends */
+void parse_unfold(pTHX_ SV *out, const char *v, const char *end) {
+    for (;;) {
+        const char *nl = (const char *) memchr(v, '\n', end - v);
+        const char *q  = nl ? nl : end;
+
+        while ( q > v && ( PARSE_IS_WS(q[-1]) || q[-1] == '\r' ) )
+            q--;
+        sv_catpvn(out, v, q - v);
+
+        if ( nl == NULL )
+            return;
+        sv_catpvs(out, "\n");
+        v = nl + 1;
+    }
+}
+
+/* Stores a value as parse_next() found it, unfolding it in *scratch
+ * (made mortal on first use when NULL) if it has continuation lines */
+void store_parsed_value(pTHX_ HV *self, field_t *f, const char *value, STRLEN value_len,
+                        bool folded, SV **scratch) {
+    if (folded) {
+        if ( *scratch == NULL )
+            *scratch = sv_2mortal( newSV(value_len + 1) );
+        sv_setpvs(*scratch, "");
+        parse_unfold(aTHX_ *scratch, value, value + value_len);
+
+        value     = SvPVX(*scratch);
+        value_len = SvCUR(*scratch);
+    }
+    store_field_value(aTHX_ self, f, value, value_len);
+}
+
+void lazy_add(lazy_t *lazy, const char *name, STRLEN name_len,
+              const char *value, STRLEN value_len, bool folded) {
+    const char   *base = SvPVX(lazy->raw);
+    lazy_field_t *f;
+
+    if ( lazy->count == lazy->alloc ) {
+        lazy->alloc = lazy->alloc ? lazy->alloc * 2 : 32;
+        Renew(lazy->fields, lazy->alloc, lazy_field_t);
+    }
+
+    f = &lazy->fields[ lazy->count++ ];
+    f->name_off  = name - base;
+    f->name_len  = name_len;
+    f->value_off = value - base;
+    f->value_len = value_len;
+    f->folded    = folded;
+    f->done      = FALSE;
+    lazy->left++;
+}
+
+/* Parses the header lines at buf into p->headers, up to and including
+ * the empty line that ends them, or up to eof: the end of buf, when it's
+ * true. Fields are stored as new() would store them; a line starting
+ * with whitespace continues the previous one's value after a "\n", as
+ * HTTP::Message->parse() does. Returns how much of buf was parsed:
+ * complete fields only, along with their continuation lines, so a
+ * caller can feed the rest again once more arrived. p->done is set once
+ * the block is over. Croaks on malformed input. */
+STRLEN parse_lines(pTHX_ parse_t *p, const char *buf, STRLEN len, bool eof) {
+    const char    *s = buf, *end = buf + len, *why, *line;
+    parse_field_t field;
+
+    while ( s < end ) {
+        switch ( parse_next(&s, end, eof, &field, &why, &line) ) {
+        case PARSE_MORE:
+            return s - buf;
+        case PARSE_ERROR:
+            parse_croak(aTHX_ why, line, end);
+        case PARSE_END:
+            p->done = TRUE;
+            return s - buf;
+        }
+
+        if ( p->max_fields && p->fields >= p->max_fields )
+            croak("Header block over the %" UVuf " field limit", p->max_fields);
+        p->fields++;
+
+        if ( p->lazy ) {
+            lazy_add(p->lazy, field.name, field.name_len, field.value, field.value_len, field.folded);
+        } else {
+            field_t f;
+
+            /* names skipped aren't standardized, so wire names nobody
+             * asked for never reach %standard_case */
+            if ( p->only ) {
+                field_key(aTHX_ field.name, field.name_len, &f);
+                if ( !field_exists(p->only, &f) )
+                    continue;
+            }
+            handle_standard_case(aTHX_ field.name, field.name_len, &f);
+            store_parsed_value(aTHX_ p->headers, &f, field.value, field.value_len, field.folded, &p->folded);
+        }
+    }
+
+    if (eof)
+        p->done = TRUE;
+    return s - buf;
+}
+
+/* Frees parse_corpus()'s chunks (CORPUS_MAX_THREADS of them) when its
+ * scope is left, croaking or not */
+static void corpus_free_scoped(pTHX_ void *chunks) {
+    corpus_chunks_free( (corpus_chunk_t *) chunks, CORPUS_MAX_THREADS );
+    Safefree(chunks);
+}
+
+#define LAZY_CLASS "HTTP::Headers::Fast::Lazy"
+
+int lazy_free(pTHX_ SV *sv, MAGIC *mg) {
+    lazy_t *lazy = (lazy_t *) mg->mg_ptr;
+    PERL_UNUSED_ARG(sv);
+
+    SvREFCNT_dec(lazy->raw);
+    SvREFCNT_dec(lazy->stash);
+    Safefree(lazy->fields);
+    Safefree(lazy);
+    return 0;
+}
+
+#ifdef USE_ITHREADS
+int lazy_dup(pTHX_ MAGIC *mg, CLONE_PARAMS *param) {
+    lazy_t *lazy = (lazy_t *) mg->mg_ptr, *copy;
+
+    Newx(copy, 1, lazy_t);
+    *copy = *lazy;
+    copy->raw   = sv_dup_inc(lazy->raw, param);
+    copy->stash = (HV *) sv_dup_inc( (SV *) lazy->stash, param );
+    Newx(copy->fields, lazy->alloc, lazy_field_t);
+    Copy(lazy->fields, copy->fields, lazy->count, lazy_field_t);
+
+    mg->mg_ptr = (char *) copy;
+    return 0;
+}
+#endif
+
+static MGVTBL lazy_vtbl = {
+    NULL, NULL, NULL, NULL, lazy_free, NULL,
+#ifdef USE_ITHREADS
+    lazy_dup,
+#else
+    NULL,
+#endif
+    NULL
+};
+
+#define lazy_of(hv)                                                                 \
+    ( SvRMAGICAL(hv) ? mg_findext( (SV *) (hv), PERL_MAGIC_ext, &lazy_vtbl ) : NULL )
+
+/* Stores a recorded field in the hash, under f when it's given */
+void lazy_store(pTHX_ HV *self, lazy_t *lazy, lazy_field_t *lf, field_t *f) {
+    const char *base = SvPVX(lazy->raw);
+    SV         *value;
+
+    if ( lf->folded ) {
+        value = sv_2mortal( newSVpvs("") );
+        parse_unfold(aTHX_ value, base + lf->value_off, base + lf->value_off + lf->value_len);
+    } else {
+        value = NULL;
+    }
+
+    if ( f == NULL ) {
+        if (value)
+            store_field(aTHX_ self, base + lf->name_off, lf->name_len, SvPVX(value), SvCUR(value));
+        else
+            store_field(aTHX_ self, base + lf->name_off, lf->name_len, base + lf->value_off, lf->value_len);
+    } else if ( field_exists(self, f) ) {
+        push_header_value(aTHX_ self, f, value ? value : sv_2mortal( newSVpvn(base + lf->value_off, lf->value_len) ));
+    } else {
+        field_store(self, f, value ? newSVsv(value) : newSVpvn(base + lf->value_off, lf->value_len));
+    }
+
+    lf->done = TRUE;
+    lazy->left--;
+}
+
+/* Stores every value of the field f recorded in a lazy self, so that the
+ * hash has it */
+void lazy_fetch_field(pTHX_ HV *self, field_t *f) {
+    dMY_CXT;
+    MAGIC  *mg = lazy_of(self);
+    lazy_t *lazy;
+    UV     i;
+
+    if ( mg == NULL )
+        return;
+
+    lazy = (lazy_t *) mg->mg_ptr;
+    for ( i = 0; i < lazy->count && lazy->left; i++ ) {
+        lazy_field_t *lf = &lazy->fields[i];
+        const char   *name;
+        STRLEN       j;
+
+        if ( lf->done || lf->name_len != f->len )
+            continue;
+
+        /* the name as handle_standard_case() would make it */
+        name = SvPVX(lazy->raw) + lf->name_off;
+        for ( j = 0; j < f->len; j++ ) {
+            char c = isUPPER(name[j]) ? toLOWER(name[j]) : name[j];
+
+            if ( c == '_' && MY_CXT.translate )
+                c = '-';
+            if ( c != f->name[j] )
+                break;
+        }
+
+        if ( j == f->len )
+            lazy_store(aTHX_ self, lazy, lf, f);
+    }
+}
+
+#define lazy_fetch(hv, f) \
+    STMT_START { if ( SvRMAGICAL(hv) ) lazy_fetch_field(aTHX_ (hv), (f)); } STMT_END
+
+/* Stores whatever a lazy self has left, and makes it a regular object of
+ * the class parse_lazy() was called on */
+void lazy_materialize(pTHX_ SV *self) {
+    HV     *self_hash, *stash = NULL;
+    MAGIC  *mg;
+    lazy_t *lazy;
+    UV     i;
+
+    if ( !SvROK(self) || SvTYPE(SvRV(self)) != SVt_PVHV )
+        return;
+
+    self_hash = (HV *) SvRV(self);
+    if ( ( mg = lazy_of(self_hash) ) != NULL ) {
+        lazy = (lazy_t *) mg->mg_ptr;
+        for ( i = 0; i < lazy->count && lazy->left; i++ )
+            if ( !lazy->fields[i].done )
+                lazy_store(aTHX_ self_hash, lazy, &lazy->fields[i], NULL);
+
+        /* freed along with the magic */
+        stash = (HV *) sv_2mortal( SvREFCNT_inc_simple_NN(lazy->stash) );
+        sv_unmagicext( (SV *) self_hash, PERL_MAGIC_ext, &lazy_vtbl );
+    }
+
+    if ( SvOBJECT(self_hash) && SvSTASH(self_hash) == gv_stashpvs(LAZY_CLASS, 0) )
+        sv_bless( self, stash ? stash : gv_stashpvs("HTTP::Headers::Fast", GV_ADD) );
+}
+
+#define PARSER_CLASS "HTTP::Headers::Fast::XS::Parser"
+
+/* Defaults of HTTP::Headers::Fast::XS::Parser->new() */
+#define PARSER_MAX_SIZE   65536
+#define PARSER_MAX_FIELDS 100
+
+/* State of an HTTP::Headers::Fast::XS::Parser between feed() calls */
+typedef struct {
+    parse_t state;     /* state.headers is headers' hash */
+    SV      *headers;  /* the object being filled in, or NULL */
+    HV      *stash;    /* what it's blessed into */
+    SV      *buf;      /* what was fed and not parsed yet */
+    UV      consumed;  /* bytes parsed so far */
+    UV      max_size;  /* croak past this many bytes, 0 for no limit */
+    bool    failed;    /* a feed() croaked, the state is of no use */
+} parser_t;
+
+parser_t * parser_context(pTHX_ SV *self) {
+    if ( !SvROK(self) || !sv_derived_from(self, PARSER_CLASS) )
+        croak("Not an %s object", PARSER_CLASS);
+    return INT2PTR( parser_t *, SvIV(SvRV(self)) );
+}
+
+/* Gets p ready for the next header block */
+void parser_reset(pTHX_ parser_t *p) {
+    SvREFCNT_dec(p->headers);
+    p->headers  = NULL;
+    p->consumed = 0;
+    p->failed   = FALSE;
+    sv_setpvs(p->buf, "");
+
+    p->state.headers = NULL;
+    p->state.fields  = 0;
+    p->state.done    = FALSE;
+}
+
+/* Adds chunk to what p has; returns the object once the block is over,
+ * NULL until then */
+SV * parser_feed(pTHX_ parser_t *p, SV *chunk) {
+    const char *s;
+    STRLEN     len, had;
+    bool       scan;
+
+    if (p->failed)
+        croak("%s can't go on after an error; reset() it", PARSER_CLASS);
+    if (p->state.done)
+        croak("%s already has a complete header block; reset() it", PARSER_CLASS);
+
+    if ( p->headers == NULL ) {
+        p->state.headers = newHV();
+        p->headers = sv_bless( newRV_noinc( (SV *) p->state.headers ), p->stash );
+    }
+
+    s   = SvPVbyte(chunk, len);
+    had = SvCUR(p->buf);
+
+    /* a field is parsed once the line after it starts, so there's only
+     * something new to parse when the chunk has a line end, or starts
+     * the line after one; anything else is just added */
+    scan = memchr(s, '\n', len) != NULL
+        || ( had && len && SvPVX(p->buf)[had - 1] == '\n' );
+    sv_catpvn(p->buf, s, len);
+
+    if (scan) {
+        STRLEN parsed, upto = SvCUR(p->buf);
+
+        /* nothing past max_size is parsed: a block that doesn't end
+         * before it is refused below, without storing what's beyond */
+        if ( p->max_size && upto > p->max_size - p->consumed )
+            upto = p->max_size - p->consumed;
+
+        p->failed = TRUE;
+        parsed    = parse_lines(aTHX_ &p->state, SvPVX(p->buf), upto, FALSE);
+        p->failed = FALSE;
+
+        p->consumed += parsed;
+        sv_chop( p->buf, SvPVX(p->buf) + parsed );
+    }
+
+    if ( p->max_size
+      && ( p->state.done ? p->consumed : p->consumed + SvCUR(p->buf) ) > p->max_size ) {
+        p->failed = TRUE;
+        croak("Header block over the %" UVuf " byte limit", p->max_size);
+    }
+
+    if ( !p->state.done )
+        return NULL;
+
+    {
+        SV *headers = p->headers;
+        p->headers  = NULL;
+        return headers;
+    }
+}
+
+#define ITER_CLASS "HTTP::Headers::Fast::XS::Iterator"
+
+/* What $h->iter returns a reference to. Not through the hash's iterator,
+ * which each() and keys() use: in hash order it walks the buckets of the
+ * object hash itself, without taking a copy of the keys; in as_string()
+ * order it sorts a copy of them on the first next(). */
+typedef struct {
+    HV             *headers;
+    bool           sorted;  /* as_string() order rather than hash order */
+    header_entry_t at;      /* sorted: the current field */
+    header_entry_t *keys;   /* sorted: the keys, key_sv holding each */
+    SSize_t        count;   /* in keys */
+    SSize_t        pos;     /* the next one to look up */
+    STRLEN         total;   /* HvTOTALKEYS() when last looked, to spot additions */
+    SV             *key;    /* the current field's key, NULL before the first */
+    STRLEN         bucket;  /* hash order: the current field's bucket... */
+    STRLEN         chain;   /* ...and place in it, from 1; 0 for none yet */
+    SV             *name;   /* the current field's name */
+    AV             *values; /* the current field's array, while going through it */
+    SSize_t        index;   /* in values */
+} iter_t;
+
+iter_t * iter_context(pTHX_ SV *self) {
+    if ( !SvROK(self) || !sv_derived_from(self, ITER_CLASS) )
+        croak("Not an %s object", ITER_CLASS);
+    return INT2PTR( iter_t *, SvIV(SvRV(self)) );
+}
+
+#define iter_skip(he) \
+    ( HeVAL(he) == &PL_sv_placeholder || ( HeKLEN(he) && HeKEY(he)[0] == '_' ) )
+
+static void iter_entry(HE *he, header_entry_t *entry) {
+    entry->he    = he;
+    entry->key   = HeKEY(he);
+    entry->len   = HeKLEN(he);
+    entry->utf8  = cBOOL(HeKUTF8(he));
+    entry->order = entry->utf8 ? KNOWN_HEADER_NO_ORDER : known_header_order(entry->key, entry->len);
+}
+
+static void iter_free_keys(pTHX_ iter_t *it) {
+    SSize_t i;
+
+    for ( i = 0; i < it->count; i++ )
+        SvREFCNT_dec(it->keys[i].key_sv);
+    Safefree(it->keys);
+    it->keys  = NULL;
+    it->count = 0;
+    it->pos   = 0;
+}
+
+/* Takes a sorted copy of the keys, placing pos after the current field */
+static void iter_sort_keys(pTHX_ iter_t *it) {
+    HE      **array = HvARRAY(it->headers), *he;
+    STRLEN  i;
+    SSize_t n = 0;
+
+    iter_free_keys(aTHX_ it);
+    it->total = HvTOTALKEYS(it->headers);
+    if ( array == NULL || it->total == 0 )
+        return;
+
+    Newx(it->keys, it->total, header_entry_t);
+    for ( i = 0; i <= HvMAX(it->headers); i++ ) {
+        for ( he = array[i]; he != NULL; he = HeNEXT(he) ) {
+            if ( iter_skip(he) )
+                continue;
+
+            iter_entry(he, &it->keys[n]);
+            it->keys[n].he     = NULL;
+            it->keys[n].key_sv = newSVhek( HeKEY_hek(he) );
+            it->keys[n].key    = SvPVX(it->keys[n].key_sv);
+            n++;
+        }
+    }
+    it->count = n;
+    qsort(it->keys, n, sizeof(header_entry_t), header_entry_cmp);
+
+    if ( it->key )
+        while ( it->pos < n && header_entry_cmp(&it->keys[it->pos], &it->at) <= 0 )
+            it->pos++;
+}
+
+/* The field after the current one in as_string() order. The keys are
+ * sorted once; fields deleted since are skipped, and the keys are sorted
+ * again when the hash has grown, so fields added after the current one
+ * come up. */
+HE * iter_next_sorted(pTHX_ iter_t *it) {
+    HE             *he;
+    header_entry_t *entry;
+
+    if ( it->keys == NULL || HvTOTALKEYS(it->headers) > it->total )
+        iter_sort_keys(aTHX_ it);
+    else
+        it->total = HvTOTALKEYS(it->headers);
+
+    while ( it->pos < it->count ) {
+        entry = &it->keys[ it->pos++ ];
+        he    = hv_fetch_ent(it->headers, entry->key_sv, 0, 0);
+        if ( he == NULL )
+            continue;
+
+        SvREFCNT_dec(it->key);
+        it->key    = SvREFCNT_inc_simple_NN(entry->key_sv);
+        it->at     = *entry;
+        return he;
+    }
+    return NULL;
+}
+
+#define iter_is_key(he, key)                                      \
+    ( (STRLEN) HeKLEN(he) == SvCUR(key) && HeKUTF8(he) == SvUTF8(key) \
+      && memEQ( HeKEY(he), SvPVX(key), SvCUR(key) ) )
+
+/* The next field in hash order. Deleting fields as they come up is fine;
+ * fields added meanwhile may be missed or come up twice, as with each(). */
+HE * iter_next_hashed(pTHX_ iter_t *it) {
+    HE     **array = HvARRAY(it->headers), *he;
+    STRLEN i;
+
+    if ( array == NULL )
+        return NULL;
+
+    while ( it->bucket <= HvMAX(it->headers) ) {
+        he = array[it->bucket];
+        i  = 0;
+
+        /* past the current field; it, or fields before it in the chain,
+         * may be gone by now */
+        if ( it->chain ) {
+            while ( he != NULL && !iter_is_key(he, it->key) ) {
+                he = HeNEXT(he);
+                i++;
+            }
+            if ( he != NULL ) {
+                he = HeNEXT(he);
+                i++;
+            } else {
+                for ( he = array[it->bucket], i = 0; he != NULL && i < it->chain - 1; i++ )
+                    he = HeNEXT(he);
+            }
+        }
+
+        while ( he != NULL && iter_skip(he) ) {
+            he = HeNEXT(he);
+            i++;
+        }
+        if ( he == NULL ) {
+            it->bucket++;
+            it->chain = 0;
+            continue;
+        }
+
+        SvREFCNT_dec(it->key);
+        it->key   = newSVhek( HeKEY_hek(he) );
+        it->chain = i + 1;
+        return he;
+    }
+    return NULL;
+}
+
+/* Moves to the next value, returning it with *name set, or NULL at the
+ * end. Values are the stored SVs themselves, array elements included. */
+SV * iter_next(pTHX_ iter_t *it, SV **name) {
+    HE *he;
+    SV *value, **svp;
+
+    for (;;) {
+        if ( it->values ) {
+            if ( it->index <= av_len(it->values) ) {
+                svp   = av_fetch(it->values, it->index++, 0);
+                *name = it->name;
+                return svp ? *svp : &PL_sv_undef;
+            }
+            SvREFCNT_dec(it->values);
+            it->values = NULL;
+        }
+
+        he = it->sorted ? iter_next_sorted(aTHX_ it) : iter_next_hashed(aTHX_ it);
+        if ( he == NULL )
+            return NULL;
+
+        /* $standard_case{$key} || $key; the previous name may still be on
+         * the stack, so it only goes at the end of the statement */
+        if ( it->name )
+            sv_2mortal(it->name);
+        value    = standard_case_name(aTHX_ HeKEY(he), HeKLEN(he), cBOOL(HeKUTF8(he)), HeHASH(he));
+        it->name = value ? newSVsv(value) : newSVhek( HeKEY_hek(he) );
+
+        value = HeVAL(he);
+        if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) ) {
+            it->values = (AV *) SvREFCNT_inc_simple_NN( SvRV(value) );
+            it->index  = 0;
+            continue;
+        }
+
+        *name = it->name;
+        return value;
+    }
+}
+
+void iter_reset(pTHX_ iter_t *it) {
+    iter_free_keys(aTHX_ it);
+    SvREFCNT_dec(it->key);
+    SvREFCNT_dec(it->values);
+    it->key    = NULL;
+    it->values = NULL;
+    it->bucket = 0;
+    it->chain  = 0;
+}
+
+MODULE = HTTP::Headers::Fast::XS		PACKAGE = HTTP::Headers::Fast::XS
+PROTOTYPES: DISABLE
+
+BOOT:
+{
+    int i;
+    SV  **standard_case_val, *translate;
+
+    MY_CXT_INIT;
+    fold_init();
+    parse_init();
+    hpack_init();
+    MY_CXT.standard_case = get_hv( "HTTP::Headers::Fast::standard_case", 0 );
+
+    /* the magic is copied along by local(), which then sets it */
+    translate = get_sv( "HTTP::Headers::Fast::TRANSLATE_UNDERSCORE", GV_ADD );
+    sv_magicext( translate, NULL, PERL_MAGIC_ext, &translate_underscore_vtbl, NULL, 0 );
+    MY_CXT.translate = SvTRUE(translate);
+
+    /* seed %standard_case with HTTP::Headers::Fast's own names, keeping
+     * any spelling it (or the user) already put there */
+    for ( i = 0; i < KNOWN_HEADER_COUNT; i++ ) {
+        MY_CXT.known_key[i] = newSVpvn_share( known_headers[i].name, known_headers[i].len, 0 );
+        if ( known_headers[i].canonical == NULL )
+            continue;
+
+        standard_case_val = hv_fetch(
+            MY_CXT.standard_case,
+            known_headers[i].name,
+            known_headers[i].len,
+            1
+        );
+        if (standard_case_val == NULL)
+            croak("hv_fetch() failed. This should not happen.");
+
+        if ( !SvOK(*standard_case_val) )
+            sv_setpvn( *standard_case_val, known_headers[i].canonical, known_headers[i].len );
+    }
+#ifdef ENTERSUB_CHECKER
+    /* see field_const_mark() and pp_header_method() */
+    {
+        static const char *const checked[] = {
+            "HTTP::Headers::Fast::XS::header",
+            "HTTP::Headers::Fast::XS::_header_get",
+            "HTTP::Headers::Fast::XS::push_header",
+            "HTTP::Headers::Fast::XS::_header_set",
+        };
+        CV *cv;
+
+        for ( i = 0; i < 4; i++ ) {
+            if ( ( cv = get_cv(checked[i], 0) ) == NULL )
+                croak("%s is missing. This should not happen.", checked[i]);
+
+            header_method_xsubs[i] = CvXSUB(cv);
+            if ( i < 3 )
+                cv_set_call_checker( cv, field_const_call_checker, (SV *) cv );
+        }
+
+        XopENTRY_set( &header_method_xop, xop_name,  "header_method" );
+        XopENTRY_set( &header_method_xop, xop_desc,  "HTTP::Headers::Fast method call" );
+        XopENTRY_set( &header_method_xop, xop_class, OA_UNOP );
+        Perl_custom_op_register( aTHX_ pp_header_method, &header_method_xop );
+
+        wrap_op_checker( OP_ENTERSUB, header_ck_entersub, &header_next_ck_entersub );
+    }
+#endif
+    MY_CXT.cache_keys      = NULL;
+    MY_CXT.cache_size      = 0;
+    MY_CXT.cache_alloc     = 0;
+    MY_CXT.cache_limit     = STANDARD_CASE_CACHE_LIMIT;
+    MY_CXT.cache_rand      = (U32) PTR2UV(&MY_CXT) | 1;
+    MY_CXT.cache_known     = 0;
+    MY_CXT.cache_hits      = 0;
+    MY_CXT.cache_misses    = 0;
+    MY_CXT.cache_evictions = 0;
+}
+
+IV
+standard_case_cache_limit(...)
+    PREINIT:
+        dMY_CXT;
+    CODE:
+        if (items) {
+            if ( SvIV(ST(0)) < 0 )
+                croak("standard_case cache limit must be 0 (unbounded) or more");
+
+            MY_CXT.cache_limit = SvIV(ST(0));
+            standard_case_cache_trim(aTHX);
+        }
+        RETVAL = MY_CXT.cache_limit;
+    OUTPUT: RETVAL
+
+SV *
+standard_case_cache_stats()
+    PREINIT:
+        dMY_CXT;
+        HV *stats;
+    CODE:
+        stats = newHV();
+        hv_stores( stats, "size",      newSViv(MY_CXT.cache_size) );
+        hv_stores( stats, "limit",     newSViv(MY_CXT.cache_limit) );
+        hv_stores( stats, "known",     newSVuv(MY_CXT.cache_known) );
+        hv_stores( stats, "hits",      newSVuv(MY_CXT.cache_hits) );
+        hv_stores( stats, "misses",    newSVuv(MY_CXT.cache_misses) );
+        hv_stores( stats, "evictions", newSVuv(MY_CXT.cache_evictions) );
+        RETVAL = newRV_noinc( (SV *) stats );
+    OUTPUT: RETVAL
+
+SV *
+_standardize_field_name(SV *field)
+    PREINIT:
+        field_t f;
+    CODE:
+        standardize_field_sv(aTHX_ field, &f);
+        RETVAL = newSVpvn(f.name, f.len);
+    OUTPUT: RETVAL
+
+void
+push_header( SV *self, ... )
+    PREINIT:
+        field_t f;
+        int     i;
+    CODE:
+        if ( items % 2 == 0 )
+            croak("You must provide key/value pairs");
+
+        as_string_memo_invalidate( (HV *) SvRV(self) );
+
+        for ( i = 1; i < items; i += 2 ) {
+            standardize_field_sv(aTHX_ ST(i), &f);
+            lazy_fetch( (HV *) SvRV(self), &f );
+            push_header_value(aTHX_ (HV *) SvRV(self), &f, ST(i + 1));
+       }
+
+SV *
+clone(SV *self)
+    PREINIT:
+        HV *self_hash, *copy, *stash;
+    CODE:
+        self_hash = (HV *) SvRV(self);
+        stash     = SvSTASH(self_hash);
+
+        /* tied objects and classes with Storable hooks get dclone(), as before */
+        if ( ( SvRMAGICAL(self_hash) && mg_find( (SV *) self_hash, PERL_MAGIC_tied ) )
+          || gv_fetchmethod_autoload(stash, "STORABLE_freeze", FALSE) != NULL ) {
+            RETVAL = headers_dclone(aTHX_ self);
+        } else {
+            copy   = newHV();
+            RETVAL = sv_2mortal( sv_bless( newRV_noinc( (SV *) copy ), stash ) );
+            hv_ksplit( copy, HvUSEDKEYS(self_hash) );
+
+            if ( headers_clone(aTHX_ self_hash, copy) )
+                SvREFCNT_inc_simple_void_NN(RETVAL);
+            else
+                RETVAL = headers_dclone(aTHX_ self);
+        }
+    OUTPUT: RETVAL
+
+void
+remove_header(SV *self, ...)
+    PREINIT:
+        field_t f;
+        HV      *self_hash;
+        SV      *args[items], *value;
+        I32     gimme;
+        int     arg, count;
+        SSize_t i, top;
+    PPCODE:
+        self_hash = (HV *) SvRV(self);
+        gimme     = GIMME_V;
+
+        /* the values go on the stack over the names */
+        for (arg = 1; arg < items; arg++)
+            args[arg] = ST(arg);
+
+        as_string_memo_invalidate(self_hash);
+
+        count = 0;
+        for (arg = 1; arg < items; arg++) {
+            lowercase_field_sv(aTHX_ args[arg], &f);
+            lazy_fetch(self_hash, &f);
+
+            if (gimme == G_VOID) {
+                field_delete(self_hash, &f);
+                continue;
+            }
+
+            /* the deleted value is mortal; hand it, or its elements, out
+             * as they are */
+            value = (SV *) field_common(self_hash, &f, HV_DELETE, NULL);
+            if ( value == NULL || !SvOK(value) )
+                continue;
+
+            if ( SvROK(value) && SvTYPE(SvRV(value)) == SVt_PVAV && !sv_isobject(value) ) {
+                top = av_len( (AV *) SvRV(value) );
+                if (gimme == G_ARRAY)
+                    EXTEND(SP, top + 1);
+                for (i = 0; i <= top; i++) {
+                    SV **element = av_fetch( (AV *) SvRV(value), i, 0 );
+
+                    if (gimme == G_ARRAY)
+                        PUSHs( element ? *element : &PL_sv_undef );
+                    count++;
+                }
+            } else {
+                if (gimme == G_ARRAY)
+                    XPUSHs(value);
+                count++;
+            }
+        }
+
+        if (gimme == G_VOID)
+            XSRETURN_EMPTY;
+
+        /* return @values */
+        if (gimme == G_SCALAR)
+            XSRETURN_IV(count);
+        XSRETURN(count);
+
+void
+remove_content_headers(SV *self)
+    PREINIT:
+        HV *self_hash, *removed;
+        SV *c;
+    PPCODE:
+        self_hash = (HV *) SvRV(self);
+        as_string_memo_invalidate(self_hash);
+
+        if (GIMME_V == G_VOID) {
+            headers_remove_content(aTHX_ self_hash, NULL);
+            XSRETURN_EMPTY;
+        }
+
+        /* the values move to an object of the same class, uncopied */
+        removed = newHV();
+        c       = sv_2mortal( sv_bless( newRV_noinc( (SV *) removed ), SvSTASH(self_hash) ) );
+        headers_remove_content(aTHX_ self_hash, removed);
+
+        PUSHs(c);
+        XSRETURN(1);
+
+SV *
+as_string(SV *self, SV *endl = NULL)
+    CODE:
+        RETVAL = as_string_result(aTHX_ headers_as_string(aTHX_ (HV *) SvRV(self), endl, TRUE));
+    OUTPUT: RETVAL
+
+SV *
+iter(SV *self, bool without_sort = FALSE)
+    PREINIT:
+        iter_t *it;
+    CODE:
+        Newxz(it, 1, iter_t);
+        it->headers = (HV *) SvREFCNT_inc_simple_NN( SvRV(self) );
+        it->sorted  = !without_sort;
+        RETVAL = sv_setref_pv( newSV(0), ITER_CLASS, it );
+    OUTPUT: RETVAL
+
+void
+scan(SV *self, SV *callback)
+    CODE:
+        headers_scan(aTHX_ (HV *) SvRV(self), callback);
+
+void
+header_field_names(SV *self)
+    PREINIT:
+        HV             *self_hash;
+        HE             *he;
+        header_entry_t *entries;
+        I32            count = 0, i;
+        SV             *name;
+    PPCODE:
+        self_hash = (HV *) SvRV(self);
+        if ( GIMME_V != G_ARRAY ) {
+            mXPUSHi( HvUSEDKEYS(self_hash) );
+            XSRETURN(1);
+        }
+
+        /* map $standard_case{$_} || $_, $self->_sorted_field_names */
+        entries = (header_entry_t *) SvPVX( sv_2mortal( newSV( (HvUSEDKEYS(self_hash) + 1) * sizeof(header_entry_t) ) ) );
+        hv_iterinit(self_hash);
+        while ( ( he = hv_iternext(self_hash) ) != NULL ) {
+            header_entry_t *entry = &entries[count++];
+
+            entry->he    = he;
+            entry->key   = HePV(he, entry->len);
+            entry->utf8  = cBOOL(HeUTF8(he));
+            entry->order = entry->utf8 ? KNOWN_HEADER_NO_ORDER : known_header_order(entry->key, entry->len);
+        }
+        qsort( entries, count, sizeof(header_entry_t), header_entry_cmp );
+
+        EXTEND(SP, count);
+        for ( i = 0; i < count; i++ ) {
+            name = standard_case_name(aTHX_ entries[i].key, entries[i].len, entries[i].utf8, HeHASH(entries[i].he));
+            PUSHs( name ? sv_mortalcopy(name) : sv_2mortal( newSVhek( HeKEY_hek(entries[i].he) ) ) );
+        }
+        XSRETURN(count);
+
+SV *
+as_string_without_sort(SV *self, SV *endl = NULL)
+    CODE:
+        RETVAL = as_string_result(aTHX_ headers_as_string(aTHX_ (HV *) SvRV(self), endl, FALSE));
+    OUTPUT: RETVAL
+
+void
+append_to(SV *self, SV *buf, SV *endl = NULL, bool without_sort = FALSE)
+    PREINIT:
+        HV *self_hash;
+    CODE:
+        if ( !SvROK(buf) || SvTYPE(SvRV(buf)) > SVt_PVMG || SvOBJECT(SvRV(buf)) )
+            croak("Usage: $h->append_to(\\$buf, $eol, $without_sort)");
+
+        buf       = SvRV(buf);
+        self_hash = (HV *) SvRV(self);
+
+        if ( as_string_memo(aTHX_ self_hash) ) {
+            if ( !SvOK(buf) )
+                sv_setpvs(buf, "");
+            sv_catsv( buf, headers_as_string(aTHX_ self_hash, endl, !without_sort) );
+        } else {
+            headers_serialize(aTHX_ self_hash, endl, !without_sort, buf);
+        }
+
+SV *
+to_hpack(SV *self, SV *ctx = NULL)
+    CODE:
+        RETVAL = newSVpvs("");
+        headers_to_hpack(aTHX_ (HV *) SvRV(self), ctx && SvOK(ctx) ? hpack_context(aTHX_ ctx) : NULL, FALSE, RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+parse(SV *class, SV *bytes)
+    PREINIT:
+        const char *s;
+        STRLEN     len;
+        parse_t    p;
+    CODE:
+        s = SvPVbyte(bytes, len);
+        Zero(&p, 1, parse_t);
+        p.headers = newHV();
+        RETVAL    = sv_bless( newRV_noinc( (SV *) p.headers ),
+                              SvROK(class) ? SvSTASH(SvRV(class)) : gv_stashsv(class, GV_ADD) );
+
+        /* mortal until it's filled in, so croaking frees it */
+        sv_2mortal(RETVAL);
+        parse_lines(aTHX_ &p, s, len, TRUE);
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+from_psgi_env(SV *class, SV *env)
+    CODE:
+        if ( !SvROK(env) || SvTYPE(SvRV(env)) != SVt_PVHV )
+            croak("Usage: HTTP::Headers::Fast->from_psgi_env(\\%%env)");
+
+        RETVAL = sv_bless( newRV_noinc( (SV *) newHV() ),
+                           SvROK(class) ? SvSTASH(SvRV(class)) : gv_stashsv(class, GV_ADD) );
+
+        /* mortal until it's filled in, so croaking frees it */
+        sv_2mortal(RETVAL);
+        headers_from_psgi_env(aTHX_ (HV *) SvRV(RETVAL), (HV *) SvRV(env));
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+parse_many(SV *blocks, SV *fields = NULL)
+    PREINIT:
+        AV      *in, *out;
+        HV      *stash, *only = NULL;
+        SV      *folded;
+        SSize_t i, count;
+        field_t f;
+    CODE:
+        if ( !SvROK(blocks) || SvTYPE(SvRV(blocks)) != SVt_PVAV
+             || ( fields && SvOK(fields) && ( !SvROK(fields) || SvTYPE(SvRV(fields)) != SVt_PVAV ) ) )
+            croak("Usage: HTTP::Headers::Fast::XS::parse_many(\\@blocks[, \\@fields])");
+
+        in    = (AV *) SvRV(blocks);
+        count = av_len(in) + 1;
+        stash = gv_stashpvs("HTTP::Headers::Fast", GV_ADD);
+
+        /* the result owns every object as soon as it's made, so croaking
+         * on a block frees the ones before it */
+        out    = newAV();
+        RETVAL = sv_2mortal( newRV_noinc( (SV *) out ) );
+        av_extend(out, count);
+
+        if ( fields && SvOK(fields) ) {
+            AV      *names = (AV *) SvRV(fields);
+            SSize_t n;
+
+            only = (HV *) sv_2mortal( (SV *) newHV() );
+            for ( n = 0; n <= av_len(names); n++ ) {
+                SV         **name = av_fetch(names, n, 0);
+                const char *s;
+                STRLEN     name_len;
+
+                if ( name == NULL )
+                    continue;
+                s = SvPV_const(*name, name_len);
+                field_key(aTHX_ s, name_len, &f);
+                field_store(only, &f, newSViv(1));
+            }
+        }
+
+        /* one unfolding buffer for the whole batch */
+        folded = sv_2mortal( newSV(256) );
+
+        for ( i = 0; i < count; i++ ) {
+            SV         **block = av_fetch(in, i, 0);
+            const char *s;
+            STRLEN     len;
+            parse_t    p;
+
+            Zero(&p, 1, parse_t);
+            p.headers = newHV();
+            p.only    = only;
+            p.folded  = folded;
+            av_push( out, sv_bless( newRV_noinc( (SV *) p.headers ), stash ) );
+
+            /* mortals made for this block go with it */
+            ENTER;
+            SAVETMPS;
+            if ( block == NULL ) {
+                s   = "";
+                len = 0;
+            } else {
+                s = SvPVbyte(*block, len);
+            }
+            parse_lines(aTHX_ &p, s, len, TRUE);
+            FREETMPS;
+            LEAVE;
+        }
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+parse_corpus(SV *corpus, ...)
+    PREINIT:
+        dMY_CXT;
+        const char     *buf;
+        STRLEN         len;
+        int            threads = 0, i;
+        SV             *fields = NULL, *folded;
+        corpus_want_t  *want = NULL;
+        SSize_t        want_count = 0, n;
+        corpus_chunk_t *chunks;
+        UV             blocks = 0;
+        AV             *out;
+        HV             *stash;
+        field_t        f;
+    CODE:
+        if ( items % 2 == 0 )
+            croak("Usage: HTTP::Headers::Fast::XS::parse_corpus($corpus, %%options)");
+
+        for ( i = 1; i < items; i += 2 ) {
+            const char *key = SvPV_nolen(ST(i));
+
+            if ( strEQ(key, "threads") ) {
+                threads = (int) SvIV(ST(i + 1));
+                if ( threads < 1 || threads > CORPUS_MAX_THREADS )
+                    croak("parse_corpus threads must be 1 to %d", CORPUS_MAX_THREADS);
+            } else if ( strEQ(key, "fields") ) {
+                fields = ST(i + 1);
+                if ( SvOK(fields) && ( !SvROK(fields) || SvTYPE(SvRV(fields)) != SVt_PVAV ) )
+                    croak("parse_corpus fields must be an array reference");
+            } else {
+                croak("Unknown parse_corpus option '%s'", key);
+            }
+        }
+
+        buf = SvPVbyte(corpus, len);
+        if ( !threads )
+            threads = corpus_default_threads(len);
+
+        ENTER;
+        Newxz(chunks, CORPUS_MAX_THREADS, corpus_chunk_t);
+        SAVEDESTRUCTOR_X(corpus_free_scoped, chunks);
+
+        /* workers match names against these, standardized beforehand */
+        if ( fields && SvOK(fields) ) {
+            AV *names = (AV *) SvRV(fields);
+
+            Newx(want, av_len(names) + 1, corpus_want_t);
+            SAVEFREEPV(want);
+            for ( n = 0; n <= av_len(names); n++ ) {
+                SV         **name = av_fetch(names, n, 0);
+                const char *s;
+                STRLEN     name_len;
+
+                if ( name == NULL )
+                    continue;
+                s = SvPV_const(*name, name_len);
+                field_key(aTHX_ s, name_len, &f);
+                want[want_count].name = SvPVX( sv_2mortal( newSVpvn(f.name, f.len) ) );
+                want[want_count].len  = f.len;
+                want_count++;
+            }
+        }
+
+        for ( i = 0; i < threads; i++ ) {
+            chunks[i].buf        = buf;
+            chunks[i].want       = want;
+            chunks[i].want_count = want_count;
+            chunks[i].translate  = MY_CXT.translate;
+        }
+        corpus_tokenize(buf, len, chunks, threads);
+
+        for ( i = 0; i < threads; i++ ) {
+            if ( chunks[i].no_memory )
+                croak("Out of memory tokenizing the corpus");
+            if ( chunks[i].why )
+                parse_croak(aTHX_ chunks[i].why, chunks[i].line, buf + len);
+            blocks += chunks[i].block_count;
+        }
+
+        /* the result owns every object as soon as it's made */
+        out    = newAV();
+        RETVAL = sv_2mortal( newRV_noinc( (SV *) out ) );
+        stash  = gv_stashpvs("HTTP::Headers::Fast", GV_ADD);
+        av_extend(out, blocks);
+
+        /* one unfolding buffer for the whole corpus */
+        folded = sv_2mortal( newSV(256) );
+
+        for ( i = 0; i < threads; i++ ) {
+            corpus_chunk_t *c = &chunks[i];
+            UV             b, k;
+
+            for ( b = 0; b < c->block_count; b++ ) {
+                HV *headers = newHV();
+
+                av_push( out, sv_bless( newRV_noinc( (SV *) headers ), stash ) );
+
+                ENTER;
+                SAVETMPS;
+                for ( k = 0; k < c->blocks[b].fields; k++ ) {
+                    corpus_field_t *cf = &c->fields[ c->blocks[b].first_field + k ];
+
+                    handle_standard_case(aTHX_ buf + cf->name_off, cf->name_len, &f);
+                    store_parsed_value(aTHX_ headers, &f, buf + cf->value_off, cf->value_len,
+                                       cBOOL(cf->folded), &folded);
+                }
+                FREETMPS;
+                LEAVE;
+            }
+        }
+
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+        LEAVE;
+    OUTPUT: RETVAL
+
+SV *
+parse_lazy(SV *class, SV *bytes)
+    PREINIT:
+        parse_t p;
+        lazy_t  *lazy;
+        MAGIC   *mg;
+    CODE:
+        Zero(&p, 1, parse_t);
+        p.headers = newHV();
+        RETVAL    = sv_bless( newRV_noinc( (SV *) p.headers ), gv_stashpvs(LAZY_CLASS, GV_ADD) );
+        sv_2mortal(RETVAL);
+
+        /* the magic owns the copy, and whatever was recorded so far if
+         * parsing croaks */
+        Newxz(lazy, 1, lazy_t);
+        lazy->stash = SvROK(class) ? SvSTASH(SvRV(class)) : gv_stashsv(class, GV_ADD);
+        if ( lazy->stash == SvSTASH(SvRV(RETVAL)) )
+            lazy->stash = gv_stashpvs("HTTP::Headers::Fast", GV_ADD);
+        SvREFCNT_inc_simple_void_NN(lazy->stash);
+        lazy->raw = newSV(0);
+        sv_setsv_flags( lazy->raw, bytes, SV_NOSTEAL | SV_COW_SHARED_HASH_KEYS | SV_COW_OTHER_PVS );
+        mg = sv_magicext( (SV *) p.headers, NULL, PERL_MAGIC_ext, &lazy_vtbl, (const char *) lazy, 0 );
+#ifdef USE_ITHREADS
+        mg->mg_flags |= MGf_DUP;
+#else
+        PERL_UNUSED_VAR(mg);
+#endif
+        p.lazy = lazy;
+        if ( !SvOK(lazy->raw) )
+            sv_setpvs(lazy->raw, "");
+        (void) SvPVbyte_nolen(lazy->raw);
+
+        parse_lines(aTHX_ &p, SvPVX(lazy->raw), SvCUR(lazy->raw), TRUE);
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+void
+_lazy_materialize(SV *self)
+    CODE:
+        lazy_materialize(aTHX_ self);
+
+SV *
+_lazy_class(SV *self)
+    PREINIT:
+        MAGIC *mg;
+    CODE:
+        if ( !SvROK(self) || SvTYPE(SvRV(self)) != SVt_PVHV
+          || ( mg = lazy_of( (HV *) SvRV(self) ) ) == NULL )
+            XSRETURN_UNDEF;
+        RETVAL = newSVhek( HvNAME_HEK( ( (lazy_t *) mg->mg_ptr )->stash ) );
+    OUTPUT: RETVAL
+
+SV *
+to_qpack(SV *self)
+    CODE:
+        RETVAL = newSVpvs("");
+        headers_to_hpack(aTHX_ (HV *) SvRV(self), NULL, TRUE, RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+from_qpack(SV *class, SV *bytes, UV max_size = HPACK_DEFAULT_MAX_LIST_SIZE)
+    PREINIT:
+        const char *s;
+        STRLEN     len;
+        HV         *self_hash;
+    CODE:
+        s = SvPVbyte(bytes, len);
+        self_hash = newHV();
+        RETVAL    = sv_bless( newRV_noinc( (SV *) self_hash ),
+                              SvROK(class) ? SvSTASH(SvRV(class)) : gv_stashsv(class, GV_ADD) );
+
+        /* mortal until it's filled in, so croaking frees it */
+        sv_2mortal(RETVAL);
+        headers_from_qpack(aTHX_ self_hash, (const U8 *) s, len, max_size);
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+SV *
+from_hpack(SV *class, SV *bytes, SV *ctx = NULL)
+    PREINIT:
+        hpack_table_t *t, scratch;
+        const char    *s;
+        STRLEN        len;
+        HV            *self_hash;
+    CODE:
+        s = SvPVbyte(bytes, len);
+        self_hash = newHV();
+        RETVAL    = sv_bless( newRV_noinc( (SV *) self_hash ),
+                              SvROK(class) ? SvSTASH(SvRV(class)) : gv_stashsv(class, GV_ADD) );
+
+        /* mortal until it's filled in, so croaking frees it */
+        sv_2mortal(RETVAL);
+
+        ENTER;
+        if ( ctx && SvOK(ctx) ) {
+            t = hpack_context(aTHX_ ctx);
+        } else {
+            /* a block may still refer to entries it added itself */
+            t = &scratch;
+            hpack_table_init(t, HPACK_DEFAULT_TABLE_SIZE);
+            SAVEDESTRUCTOR_X(hpack_table_free_scoped, t);
+        }
+        headers_from_hpack(aTHX_ self_hash, t, (const U8 *) s, len);
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+        LEAVE;
+    OUTPUT: RETVAL
+
+void
+memoize_as_string(SV *self, bool on = TRUE)
+    PREINIT:
+        HV               *self_hash;
+        as_string_memo_t *memo;
+        MAGIC            *mg;
+    CODE:
+        if ( !SvROK(self) || SvTYPE(SvRV(self)) != SVt_PVHV )
+            croak("Usage: HTTP::Headers::Fast::XS::memoize_as_string($h, $on)");
+
+        self_hash = (HV *) SvRV(self);
+        if ( on && !as_string_memo(aTHX_ self_hash) ) {
+            Newxz(memo, 1, as_string_memo_t);
+            memo->refcnt = 1;
+            memo->live   = TRUE;
+            mg = sv_magicext( (SV *) self_hash, NULL, PERL_MAGIC_ext, &as_string_memo_vtbl, (const char *) memo, 0 );
+#ifdef USE_ITHREADS
+            mg->mg_flags |= MGf_DUP;
+#else
+            PERL_UNUSED_VAR(mg);
+#endif
+        } else if ( !on ) {
+            sv_unmagicext( (SV *) self_hash, PERL_MAGIC_ext, &as_string_memo_vtbl );
+        }
+
+void
+header(SV *self, ...)
+    PREINIT:
+        field_t f;
+        int     arg, count;
+        SV      *args[items], *value;
+        HV      *seen, *self_hash;
+    PPCODE:
+        if (items <= 1)
+            croak("Usage: $h->header($field, ...)");
+
+        /* check if we can skip preparing the results */
+        self_hash = (HV *) SvRV(self);
+
+        if (items == 2) {
+            /* @old = $self->_header_get(@_) */
+            standardize_field_sv(aTHX_ ST(1), &f);
+            lazy_fetch(self_hash, &f);
+            value = get_header_value(aTHX_ self_hash, &f);
+        } else if (items == 3) {
+            /* @old = $self->_header_set(@_) */
+            as_string_memo_invalidate(self_hash);
+            standardize_field_sv(aTHX_ ST(1), &f);
+            lazy_fetch(self_hash, &f);
+            value = get_header_value(aTHX_ self_hash, &f);
+
+            /* the old value is returned after it's replaced */
+            if (value != NULL)
+                sv_2mortal( SvREFCNT_inc_simple_NN(value) );
+
+            if ( value != NULL && !SvOK(ST(2)) ) {
+                field_delete(self_hash, &f);
+            } else {
+                set_header_value(aTHX_ self_hash, &f, ST(2));
+            }
+        } else {
+            /* save the args from the stack since _header_push()
+             * might overwrite them with results */
+            for (arg = 1; arg < items; arg++)
+                args[arg] = ST(arg);
+
+            as_string_memo_invalidate(self_hash);
+
+            seen = (HV *) sv_2mortal( (SV *) newHV() );
+            for (arg = 1; arg < items; arg += 2) {
+                standardize_field_sv(aTHX_ args[arg], &f); /* lc $field */
+                lazy_fetch(self_hash, &f);
+
+                if ( !field_exists(seen, &f) ) {
+                    field_store(seen, &f, newSViv(1));
+
+                    /* @old = $self->_header_set($field, shift) */
+                    value = get_header_value(aTHX_ self_hash, &f);
+                    if (value != NULL)
+                        sv_2mortal( SvREFCNT_inc_simple_NN(value) );
+
+                    if ( value != NULL && !SvOK(args[arg + 1]) ) {
+                        field_delete(self_hash, &f);
+                    } else {
+                        set_header_value(aTHX_ self_hash, &f, args[arg + 1]);
+                    }
+                } else {
+                    /* @old = $self->_header_push($field, shift) */
+                    value = get_header_value(aTHX_ self_hash, &f);
+                    push_header_value(aTHX_ self_hash, &f, args[arg + 1]);
+                }
+            }
+        }
+
+        if (GIMME_V == G_VOID)
+            XSRETURN_EMPTY;
+
+        if (value == NULL) {
+            /* return wantarray ? () : undef */
+            if (GIMME_V == G_ARRAY)
+                XSRETURN_EMPTY;
+            else
+                XSRETURN_UNDEF;
+        }
+
+        if (SvROK(value) && (SvTYPE(SvRV(value)) == SVt_PVAV) && !sv_isobject(value)) {
+            if (GIMME_V == G_ARRAY) {
+                /* return @old */
+                PUTBACK;
+                count = put_array_values_on_perl_stack(aTHX_ (AV *) SvRV(value));
+                SPAGAIN;
+
+                XSRETURN(count);
+            } else {
+                /* return join( ', ', @old ) */
+                value = join(aTHX_ (AV *) SvRV(value));
+                PUSHs(sv_2mortal(value));
+                XSRETURN(1);
+            }
+        } else {
+            /* return $old[0] */
+            PUSHs(sv_2mortal(newSVsv(value)));
+            XSRETURN(1);
+        }
+
+void
+_header_get( SV *self, SV *field_name, ... )
+    PREINIT:
+        field_t f;
+    PPCODE:
+        if ( items == 3 && SvTRUE(ST(2)) ) {
+            /* skip standardization */
+            f.name = SvPV_const(field_name, f.len);
+            f.key  = NULL;
+            PERL_HASH(f.hash, f.name, f.len);
+        } else {
+            standardize_field_sv(aTHX_ field_name, &f);
+        }
+        lazy_fetch( (HV *) SvRV(self), &f );
+
+        /* we are putting the decremented(with the number of input parameters) SP back in the THX */
+        PUTBACK;
+
+        XSRETURN( put_header_value_on_perl_stack(aTHX_ self, &f) );
+
+void
+_header_set(SV *self, SV *field_name, SV *val)
+    PREINIT:
+        field_t f;
+        int     count;
+    PPCODE:
+        standardize_field_sv(aTHX_ field_name, &f);
+        lazy_fetch( (HV *) SvRV(self), &f );
+
+        /* we are putting the decremented(with the number of input parameters) SP back in the THX */
+        PUTBACK;
+
+        count = put_header_value_on_perl_stack(aTHX_ self, &f);
+
+        /* we are setting the local SP variable to the value in THX */
+        SPAGAIN;
+
+        as_string_memo_invalidate( (HV *) SvRV(self) );
+
+        if (!SvOK(val) && count) {
+            field_delete((HV *) SvRV(self), &f);
+        } else {
+            set_header_value(aTHX_ (HV *)SvRV(self), &f, val);
+        }
+
+        XSRETURN(count);
+
+void
+get_many(SV *self, ...)
+    PREINIT:
+        field_t f;
+        HV      *self_hash;
+        SV      *value;
+        int     arg;
+    PPCODE:
+        self_hash = (HV *) SvRV(self);
+
+        /* each value goes where the name before it was, so the stack
+         * needs neither growing nor a copy of the names */
+        for (arg = 1; arg < items; arg++) {
+            standardize_field_sv(aTHX_ ST(arg), &f);
+            lazy_fetch(self_hash, &f);
+
+            value = get_header_scalar(aTHX_ self_hash, &f);
+            ST(arg - 1) = value ? sv_2mortal(value) : &PL_sv_undef;
+        }
+
+        XSRETURN(items - 1);
+
+SV *
+get_many_hashref(SV *self, ...)
+    PREINIT:
+        field_t f;
+        HV      *self_hash, *values;
+        SV      *value;
+        int     arg;
+    CODE:
+        self_hash = (HV *) SvRV(self);
+        values    = newHV();
+        RETVAL    = sv_2mortal( newRV_noinc( (SV *) values ) );
+
+        for (arg = 1; arg < items; arg++) {
+            standardize_field_sv(aTHX_ ST(arg), &f);
+            lazy_fetch(self_hash, &f);
+
+            value = get_header_scalar(aTHX_ self_hash, &f);
+            (void) hv_store_ent( values, ST(arg), value ? value : newSV(0), 0 );
+        }
+
+        SvREFCNT_inc_simple_void_NN(RETVAL);
+    OUTPUT: RETVAL
+
+MODULE = HTTP::Headers::Fast::XS		PACKAGE = HTTP::Headers::Fast::XS::HPACK
+
+SV *
+new(const char *class, UV max_table_size = HPACK_DEFAULT_TABLE_SIZE)
+    PREINIT:
+        hpack_table_t *t;
+    CODE:
+        Newx(t, 1, hpack_table_t);
+        hpack_table_init(t, max_table_size);
+        RETVAL = sv_setref_pv( newSV(0), class, t );
+    OUTPUT: RETVAL
+
+UV
+max_table_size(SV *self, ...)
+    PREINIT:
+        hpack_table_t *t;
+    CODE:
+        t = hpack_context(aTHX_ self);
+        if ( items > 1 ) {
+            t->settings_size = SvUV(ST(1));
+            hpack_table_resize(t, t->settings_size);
+            if ( t->max_size < t->update_min )
+                t->update_min = t->max_size;
+            t->update = TRUE;
+        }
+        RETVAL = t->max_size;
+    OUTPUT: RETVAL
+
+UV
+table_size(SV *self)
+    CODE:
+        RETVAL = hpack_context(aTHX_ self)->size;
+    OUTPUT: RETVAL
+
+UV
+max_header_list_size(SV *self, ...)
+    PREINIT:
+        hpack_table_t *t;
+    CODE:
+        t = hpack_context(aTHX_ self);
+        if ( items > 1 )
+            t->max_list_size = SvUV(ST(1));
+        RETVAL = t->max_list_size;
+    OUTPUT: RETVAL
+
+void
+DESTROY(SV *self)
+    PREINIT:
+        hpack_table_t *t;
+    CODE:
+        t = hpack_context(aTHX_ self);
+        hpack_table_free(t);
+        Safefree(t);
+
+MODULE = HTTP::Headers::Fast::XS		PACKAGE = HTTP::Headers::Fast::XS::Parser
+
+SV *
+new(const char *class, ...)
+    PREINIT:
+        parser_t *p;
+        int      i;
+    CODE:
+        if ( items % 2 == 0 )
+            croak("Usage: %s->new(%%options)", PARSER_CLASS);
+
+        Newxz(p, 1, parser_t);
+        p->max_size         = PARSER_MAX_SIZE;
+        p->state.max_fields = PARSER_MAX_FIELDS;
+        p->stash            = (HV *) SvREFCNT_inc_simple_NN( gv_stashpvs("HTTP::Headers::Fast", GV_ADD) );
+        p->buf              = newSVpvs("");
+        RETVAL = sv_setref_pv( newSV(0), class, p );
+
+        for ( i = 1; i < items; i += 2 ) {
+            const char *key = SvPV_nolen(ST(i));
+
+            if ( strEQ(key, "max_size") )
+                p->max_size = SvUV(ST(i + 1));
+            else if ( strEQ(key, "max_fields") )
+                p->state.max_fields = SvUV(ST(i + 1));
+            else if ( strEQ(key, "class") ) {
+                SvREFCNT_dec(p->stash);
+                p->stash = (HV *) SvREFCNT_inc_simple_NN( gv_stashsv(ST(i + 1), GV_ADD) );
+            } else {
+                SvREFCNT_dec(RETVAL);
+                croak("Unknown %s option '%s'", PARSER_CLASS, key);
+            }
+        }
+    OUTPUT: RETVAL
+
+SV *
+feed(SV *self, SV *chunk)
+    CODE:
+        RETVAL = parser_feed(aTHX_ parser_context(aTHX_ self), chunk);
+        if ( RETVAL == NULL )
+            XSRETURN_UNDEF;
+    OUTPUT: RETVAL
+
+SV *
+leftover(SV *self)
+    PREINIT:
+        parser_t *p;
+    CODE:
+        p = parser_context(aTHX_ self);
+        RETVAL = p->state.done ? newSVsv(p->buf) : newSVpvs("");
+    OUTPUT: RETVAL
+
+UV
+fields(SV *self)
+    CODE:
+        RETVAL = parser_context(aTHX_ self)->state.fields;
+    OUTPUT: RETVAL
+
+UV
+consumed(SV *self)
+    CODE:
+        RETVAL = parser_context(aTHX_ self)->consumed;
+    OUTPUT: RETVAL
+
+void
+reset(SV *self)
+    CODE:
+        parser_reset(aTHX_ parser_context(aTHX_ self));
+
+void
+DESTROY(SV *self)
+    PREINIT:
+        parser_t *p;
+    CODE:
+        p = parser_context(aTHX_ self);
+        SvREFCNT_dec(p->headers);
+        SvREFCNT_dec(p->buf);
+        SvREFCNT_dec(p->stash);
+        Safefree(p);
+
+MODULE = HTTP::Headers::Fast::XS		PACKAGE = HTTP::Headers::Fast::XS::Iterator
+
+void
+next(SV *self)
+    PREINIT:
+        SV *name, *value;
+    PPCODE:
+        value = iter_next(aTHX_ iter_context(aTHX_ self), &name);
+        if ( value == NULL )
+            XSRETURN_EMPTY;
+
+        /* each() style: the name alone in scalar context */
+        if ( GIMME_V == G_SCALAR ) {
+            PUSHs(name);
+            XSRETURN(1);
+        }
+        EXTEND(SP, 2);
+        PUSHs(name);
+        PUSHs(value);
+        XSRETURN(2);
+
+void
+reset(SV *self)
+    CODE:
+        iter_reset(aTHX_ iter_context(aTHX_ self));
+
+void
+DESTROY(SV *self)
+    PREINIT:
+        iter_t *it;
+    CODE:
+        it = iter_context(aTHX_ self);
+        iter_reset(aTHX_ it);
+        SvREFCNT_dec(it->name);
+        SvREFCNT_dec(it->headers);
+        Safefree(it);
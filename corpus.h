@@ -0,0 +1,227 @@
+/*
+ * Tokenizing a corpus of header blocks, each ending with an empty line,
+ * on worker threads for parse_corpus(). The corpus is cut into chunks at
+ * block boundaries; each worker runs parse_next() over its chunk and
+ * records fields as offsets into the corpus, skipping those not asked
+ * for. XS.xs then makes perl values out of them on the calling thread.
+ *
+ * Nothing here depends on perl, which the workers must not touch: they
+ * allocate with malloc() and report running out of memory, or the first
+ * malformed line of their chunk, for the caller to croak about.
+ */
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "parse.h"
+
+#ifndef _WIN32
+#  define CORPUS_HAVE_THREADS 1
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+#define CORPUS_MAX_THREADS 64
+
+/* Corpus bytes per thread below which starting another one isn't worth it */
+#define CORPUS_MIN_CHUNK 65536
+
+typedef struct {
+    size_t name_off;
+    size_t name_len;
+    size_t value_off;
+    size_t value_len;
+    int    folded;
+} corpus_field_t;
+
+typedef struct {
+    size_t first_field; /* in the chunk's fields */
+    size_t fields;
+} corpus_block_t;
+
+/* A field name asked for, lowercased */
+typedef struct {
+    const char *name;
+    size_t     len;
+} corpus_want_t;
+
+typedef struct {
+    const char          *buf;
+    size_t              start, end;
+    const corpus_want_t *want;       /* NULL for every field */
+    size_t              want_count;
+    int                 translate;   /* '_' in names matches a wanted '-' */
+
+    corpus_block_t      *blocks;
+    size_t              block_count, block_alloc;
+    corpus_field_t      *fields;
+    size_t              field_count, field_alloc;
+
+    int                 no_memory;
+    const char          *why;        /* the first malformed line, if any */
+    const char          *line;
+} corpus_chunk_t;
+
+/* Grows an array of n elements of size to hold one more */
+static int corpus_grow(void **array, size_t *alloc, size_t n, size_t size) {
+    void   *grown;
+    size_t want;
+
+    if ( n < *alloc )
+        return 1;
+
+    want  = *alloc ? 2 * *alloc : 64;
+    grown = realloc(*array, want * size);
+    if ( grown == NULL )
+        return 0;
+
+    *array = grown;
+    *alloc = want;
+    return 1;
+}
+
+static int corpus_wanted(const corpus_chunk_t *c, const char *name, size_t len) {
+    size_t i, j;
+
+    for ( i = 0; i < c->want_count; i++ ) {
+        const corpus_want_t *w = &c->want[i];
+
+        if ( w->len != len )
+            continue;
+        for ( j = 0; j < len; j++ ) {
+            char ch = name[j] >= 'A' && name[j] <= 'Z' ? name[j] - 'A' + 'a' : name[j];
+
+            if ( ch == '_' && c->translate )
+                ch = '-';
+            if ( ch != w->name[j] )
+                break;
+        }
+        if ( j == len )
+            return 1;
+    }
+    return 0;
+}
+
+/* Tokenizes the blocks of one chunk */
+static void *corpus_chunk_run(void *arg) {
+    corpus_chunk_t *c = (corpus_chunk_t *) arg;
+    const char     *s = c->buf + c->start, *end = c->buf + c->end;
+    parse_field_t  field;
+
+    while ( s < end ) {
+        corpus_block_t *block;
+
+        if ( !corpus_grow( (void **) &c->blocks, &c->block_alloc, c->block_count, sizeof(corpus_block_t) ) ) {
+            c->no_memory = 1;
+            return NULL;
+        }
+        block = &c->blocks[ c->block_count++ ];
+        block->first_field = c->field_count;
+
+        while ( s < end ) {
+            int got = parse_next(&s, end, 1, &field, &c->why, &c->line);
+
+            if ( got == PARSE_END )
+                break;
+            if ( got != PARSE_FIELD )
+                return NULL;
+
+            if ( c->want && !corpus_wanted(c, field.name, field.name_len) )
+                continue;
+
+            if ( !corpus_grow( (void **) &c->fields, &c->field_alloc, c->field_count, sizeof(corpus_field_t) ) ) {
+                c->no_memory = 1;
+                return NULL;
+            }
+            c->fields[ c->field_count ].name_off  = field.name - c->buf;
+            c->fields[ c->field_count ].name_len  = field.name_len;
+            c->fields[ c->field_count ].value_off = field.value - c->buf;
+            c->fields[ c->field_count ].value_len = field.value_len;
+            c->fields[ c->field_count ].folded    = field.folded;
+            c->field_count++;
+        }
+        block->fields = c->field_count - block->first_field;
+    }
+    return NULL;
+}
+
+/* The first block starting at or after from: blocks start after an empty
+ * line, or at the start of the corpus */
+static size_t corpus_block_start(const char *buf, size_t len, size_t from) {
+    const char *nl;
+
+    if ( from == 0 )
+        return 0;
+
+    for ( nl = buf + from - 1; ( nl = (const char *) memchr(nl, '\n', buf + len - nl) ) != NULL; nl++ ) {
+        size_t b = nl - buf; /* the LF ending a line, empty if it has nothing before it */
+
+        if ( b == 0 || buf[b - 1] == '\n' )
+            return b + 1;
+        if ( buf[b - 1] == '\r' && ( b == 1 || buf[b - 2] == '\n' ) )
+            return b + 1;
+    }
+    return len;
+}
+
+/* Number of threads parse_corpus() uses unless told otherwise */
+static int corpus_default_threads(size_t len) {
+    long cpus = 1;
+    int  n;
+
+#if defined(CORPUS_HAVE_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    n = cpus < 1 ? 1 : cpus > CORPUS_MAX_THREADS ? CORPUS_MAX_THREADS : (int) cpus;
+    if ( (size_t) n > len / CORPUS_MIN_CHUNK + 1 )
+        n = (int) ( len / CORPUS_MIN_CHUNK + 1 );
+    return n;
+}
+
+/* Splits buf into n chunks (filled in by the caller except for their
+ * bounds and results, which start out zeroed) and tokenizes them, chunk 0
+ * on the calling thread. Without threads, or when one can't be started,
+ * the calling thread does the work. */
+static void corpus_tokenize(const char *buf, size_t len, corpus_chunk_t *chunks, int n) {
+#ifdef CORPUS_HAVE_THREADS
+    pthread_t tid[CORPUS_MAX_THREADS];
+    int       started[CORPUS_MAX_THREADS];
+#endif
+    int i;
+
+    for ( i = 0; i < n; i++ ) {
+        chunks[i].start = i ? chunks[i - 1].end : 0;
+        chunks[i].end   = i == n - 1 ? len : corpus_block_start(buf, len, len / n * ( i + 1 ));
+        if ( chunks[i].end < chunks[i].start )
+            chunks[i].end = chunks[i].start;
+    }
+
+#ifdef CORPUS_HAVE_THREADS
+    for ( i = 1; i < n; i++ )
+        started[i] = pthread_create(&tid[i], NULL, corpus_chunk_run, &chunks[i]) == 0;
+    corpus_chunk_run(&chunks[0]);
+    for ( i = 1; i < n; i++ ) {
+        if ( started[i] )
+            pthread_join(tid[i], NULL);
+        else
+            corpus_chunk_run(&chunks[i]);
+    }
+#else
+    for ( i = 0; i < n; i++ )
+        corpus_chunk_run(&chunks[i]);
+#endif
+}
+
+static void corpus_chunks_free(corpus_chunk_t *chunks, int n) {
+    int i;
+
+    for ( i = 0; i < n; i++ ) {
+        free(chunks[i].blocks);
+        free(chunks[i].fields);
+        chunks[i].blocks = NULL;
+        chunks[i].fields = NULL;
+    }
+}
+
+#endif /* CORPUS_H */
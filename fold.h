@@ -0,0 +1,231 @@
+/*
+ * Field name folding: ASCII lowercasing, optional '_' -> '-' translation
+ * and word-boundary title-casing in a single pass.
+ *
+ * fold_field_name(src, lc, tc, len, translate) writes the lowercased name
+ * to lc and, when tc is not NULL, the %standard_case spelling to tc: the
+ * translated name with the first letter after every non-word character
+ * uppercased and everything else left as it was. lc may alias src.
+ *
+ * The kernel is picked at runtime by fold_init(): AVX2 when the CPU has
+ * it, SSE2 on any other x86-64, and plain C everywhere else. This file
+ * does not depend on perl so tools/fold_bench.c can include it directly.
+ */
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(_M_X64))
+#  define FOLD_HAVE_SSE2 1
+#  include <emmintrin.h>
+#  if defined(__clang__) || __GNUC__ >= 5
+#    define FOLD_HAVE_AVX2 1
+#    include <immintrin.h>
+#  endif
+#endif
+
+#ifdef __GNUC__
+#  define FOLD_UNUSED __attribute__((unused))
+#else
+#  define FOLD_UNUSED
+#endif
+
+typedef void (*fold_fn)(const char *src, char *lc, char *tc, size_t len, int translate);
+
+#define FOLD_IS_WORD(c) (                  \
+       ((c) >= 'a' && (c) <= 'z')          \
+    || ((c) >= 'A' && (c) <= 'Z')          \
+    || ((c) >= '0' && (c) <= '9')          \
+    || (c) == '_' )
+
+FOLD_UNUSED
+static void fold_field_name_scalar(const char *src, char *lc, char *tc, size_t len, int translate) {
+    size_t i;
+    int    boundary = 1;
+
+    for ( i = 0; i < len; i++ ) {
+        unsigned char c = (unsigned char) src[i];
+
+        if ( translate && c == '_' )
+            c = '-';
+
+        if (tc)
+            tc[i] = ( boundary && c >= 'a' && c <= 'z' ) ? c - 0x20 : c;
+
+        boundary = !FOLD_IS_WORD(c);
+        lc[i]    = ( c >= 'A' && c <= 'Z' ) ? c + 0x20 : c;
+    }
+}
+
+#ifdef FOLD_HAVE_SSE2
+
+/* Folds one 16 byte block; *carry is all-ones when the byte before the
+ * block was not a word character (or the block starts the name). */
+static inline void fold_block_sse2(__m128i v, __m128i *lc, __m128i *tc, __m128i *carry, int translate) {
+    const __m128i bit    = _mm_set1_epi8(0x20);
+    __m128i upper, lower, digit, word, boundary;
+
+    if (translate) {
+        __m128i us = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        v = _mm_or_si128( _mm_andnot_si128(us, v), _mm_and_si128(us, _mm_set1_epi8('-')) );
+    }
+
+    /* bytes >= 0x80 are negative as signed chars, so they never match */
+    upper = _mm_and_si128( _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)) );
+    lower = _mm_and_si128( _mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)) );
+    digit = _mm_and_si128( _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)) );
+    word  = _mm_or_si128( _mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))) );
+
+    /* a byte starts a word when the byte before it is not a word char */
+    boundary = _mm_or_si128( _mm_slli_si128(_mm_xor_si128(word, _mm_set1_epi8(-1)), 1), *carry );
+    *carry   = _mm_srli_si128( _mm_xor_si128(word, _mm_set1_epi8(-1)), 15 );
+
+    *lc = _mm_or_si128( v, _mm_and_si128(upper, bit) );
+    *tc = _mm_xor_si128( v, _mm_and_si128(_mm_and_si128(boundary, lower), bit) );
+}
+
+/* Loads the len < 16 bytes at src; reading a whole vector is fine as long
+ * as it does not cross into the next page. */
+static inline __m128i fold_load_partial(const char *src, size_t len) {
+    char buf[16];
+
+    if ( ( (size_t) src & 4095 ) <= 4096 - 16 )
+        return _mm_loadu_si128( (const __m128i *) src );
+
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, src, len);
+    return _mm_loadu_si128( (const __m128i *) buf );
+}
+
+static inline void fold_store_partial(char *dst, __m128i v, size_t len) {
+    char buf[16];
+
+    _mm_storeu_si128( (__m128i *) buf, v );
+    memcpy(dst, buf, len);
+}
+
+static void fold_field_name_sse2(const char *src, char *lc, char *tc, size_t len, int translate) {
+    __m128i carry = _mm_cvtsi32_si128(0xff);
+    __m128i l, t, last_l, last_t;
+    size_t  i = 0;
+
+    if ( len < 16 ) {
+        fold_block_sse2( fold_load_partial(src, len), &l, &t, &carry, translate );
+        fold_store_partial(lc, l, len);
+        if (tc)
+            fold_store_partial(tc, t, len);
+        return;
+    }
+
+    /* fold the last, possibly overlapping, 16 bytes before anything is
+     * stored, so that lc may alias src */
+    {
+        unsigned char prev = (unsigned char) ( len > 16 ? src[len - 17] : 0 );
+        __m128i last_carry;
+
+        if ( translate && prev == '_' )
+            prev = '-';
+        last_carry = _mm_cvtsi32_si128( len > 16 && FOLD_IS_WORD(prev) ? 0 : 0xff );
+        fold_block_sse2( _mm_loadu_si128((const __m128i *) (src + len - 16)), &last_l, &last_t, &last_carry, translate );
+    }
+
+    for ( ; i + 16 < len; i += 16 ) {
+        fold_block_sse2( _mm_loadu_si128((const __m128i *) (src + i)), &l, &t, &carry, translate );
+        _mm_storeu_si128( (__m128i *) (lc + i), l );
+        if (tc)
+            _mm_storeu_si128( (__m128i *) (tc + i), t );
+    }
+
+    _mm_storeu_si128( (__m128i *) (lc + len - 16), last_l );
+    if (tc)
+        _mm_storeu_si128( (__m128i *) (tc + len - 16), last_t );
+}
+
+#endif /* FOLD_HAVE_SSE2 */
+
+#ifdef FOLD_HAVE_AVX2
+
+/* As fold_block_sse2(), 32 bytes at a time; only byte 0 of *carry is used */
+__attribute__((target("avx2")))
+static inline void fold_block_avx2(__m256i v, __m256i *lc, __m256i *tc, __m256i *carry, int translate) {
+    const __m256i bit   = _mm256_set1_epi8(0x20);
+    const __m256i first = _mm256_setr_epi8(-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                           0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i upper, lower, digit, word, nonword, boundary;
+
+    if (translate)
+        v = _mm256_blendv_epi8( v, _mm256_set1_epi8('-'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')) );
+
+    upper = _mm256_and_si256( _mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v) );
+    lower = _mm256_and_si256( _mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v) );
+    digit = _mm256_and_si256( _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v) );
+    word  = _mm256_or_si256( _mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))) );
+
+    /* shift nonword left by one byte, across the two 128-bit lanes */
+    nonword  = _mm256_xor_si256( word, _mm256_set1_epi8(-1) );
+    boundary = _mm256_or_si256(
+        _mm256_alignr_epi8( nonword, _mm256_permute2x128_si256(nonword, nonword, 0x08), 15 ),
+        *carry
+    );
+    *carry = _mm256_and_si256( _mm256_permute4x64_epi64(_mm256_srli_si256(nonword, 15), 0x02), first );
+
+    *lc = _mm256_or_si256( v, _mm256_and_si256(upper, bit) );
+    *tc = _mm256_xor_si256( v, _mm256_and_si256(_mm256_and_si256(boundary, lower), bit) );
+}
+
+__attribute__((target("avx2")))
+static void fold_field_name_avx2(const char *src, char *lc, char *tc, size_t len, int translate) {
+    __m256i carry = _mm256_setr_epi8(-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i l, t, last_l, last_t;
+    size_t  i = 0;
+
+    /* most names are shorter than a 32 byte vector */
+    if ( len < 32 ) {
+        fold_field_name_sse2(src, lc, tc, len, translate);
+        return;
+    }
+
+    /* same overlapping-last-block scheme as fold_field_name_sse2() */
+    {
+        unsigned char prev = (unsigned char) ( len > 32 ? src[len - 33] : 0 );
+        __m256i last_carry;
+
+        if ( translate && prev == '_' )
+            prev = '-';
+        last_carry = ( len > 32 && FOLD_IS_WORD(prev) ) ? _mm256_setzero_si256() : carry;
+        fold_block_avx2( _mm256_loadu_si256((const __m256i *) (src + len - 32)), &last_l, &last_t, &last_carry, translate );
+    }
+
+    for ( ; i + 32 < len; i += 32 ) {
+        fold_block_avx2( _mm256_loadu_si256((const __m256i *) (src + i)), &l, &t, &carry, translate );
+        _mm256_storeu_si256( (__m256i *) (lc + i), l );
+        if (tc)
+            _mm256_storeu_si256( (__m256i *) (tc + i), t );
+    }
+
+    _mm256_storeu_si256( (__m256i *) (lc + len - 32), last_l );
+    if (tc)
+        _mm256_storeu_si256( (__m256i *) (tc + len - 32), last_t );
+}
+
+#endif /* FOLD_HAVE_AVX2 */
+
+#if defined(FOLD_HAVE_SSE2)
+static fold_fn fold_field_name = fold_field_name_sse2;
+#else
+static fold_fn fold_field_name = fold_field_name_scalar;
+#endif
+
+/* Picks the widest kernel the running CPU supports */
+static void fold_init(void) {
+#ifdef FOLD_HAVE_AVX2
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") )
+        fold_field_name = fold_field_name_avx2;
+#endif
+}
+
+#endif /* FOLD_H */
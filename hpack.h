@@ -0,0 +1,297 @@
+/*
+ * HPACK (RFC 7541) building blocks: prefixed integers, Huffman coded
+ * strings and the dynamic table. XS.xs does the rest: walking the
+ * object hash, picking representations and the perl side of contexts.
+ */
+#ifndef HPACK_H
+#define HPACK_H
+
+#include "hpack_tables.h"
+
+/* Each dynamic table entry counts its name and value plus this */
+#define HPACK_ENTRY_OVERHEAD 32
+
+/* SETTINGS_HEADER_TABLE_SIZE default */
+#define HPACK_DEFAULT_TABLE_SIZE 4096
+
+/* Decoders' SETTINGS_MAX_HEADER_LIST_SIZE default: HTTP/2 leaves it
+ * unlimited, which lets a small block decode into a huge list */
+#define HPACK_DEFAULT_MAX_LIST_SIZE 65536
+
+/* Writes value as an integer with an n bit prefix, the bits above the
+ * prefix in the first byte taken from first. Returns the bytes written,
+ * at most 1 + (bits in UV + 6) / 7. */
+static STRLEN hpack_put_int(U8 *d, U8 first, int n, UV value) {
+    const UV max = ( (UV) 1 << n ) - 1;
+    U8       *start = d;
+
+    if ( value < max ) {
+        *d = first | (U8) value;
+        return 1;
+    }
+
+    *d++ = first | (U8) max;
+    value -= max;
+    while ( value >= 0x80 ) {
+        *d++ = (U8) ( value & 0x7f ) | 0x80;
+        value >>= 7;
+    }
+    *d++ = (U8) value;
+    return d - start;
+}
+
+/* Reads an integer with an n bit prefix. Returns the bytes read, or 0
+ * when it's truncated or doesn't fit in 32 bits. */
+static STRLEN hpack_get_int(const U8 *s, const U8 *end, int n, UV *value) {
+    const UV max = ( (UV) 1 << n ) - 1;
+    const U8 *start = s;
+    UV       v;
+    int      shift = 0;
+
+    if ( s >= end )
+        return 0;
+
+    v = *s++ & max;
+    if ( v < max ) {
+        *value = v;
+        return 1;
+    }
+
+    do {
+        if ( s >= end || shift > 28 )
+            return 0;
+        v += (UV) ( *s & 0x7f ) << shift;
+        shift += 7;
+    } while ( *s++ & 0x80 );
+
+    if ( v > 0xffffffffU )
+        return 0;
+
+    *value = v;
+    return s - start;
+}
+
+/* Bytes s takes Huffman coded */
+static STRLEN hpack_huffman_size(const U8 *s, STRLEN len) {
+    UV     bits = 0;
+    STRLEN i;
+
+    for ( i = 0; i < len; i++ )
+        bits += hpack_huffman_len[ s[i] ];
+    return (STRLEN) ( ( bits + 7 ) / 8 );
+}
+
+/* Huffman codes s into d, which has room for hpack_huffman_size() bytes;
+ * returns the bytes written */
+static STRLEN hpack_huffman_encode(const U8 *s, STRLEN len, U8 *d) {
+    U8     *start = d;
+    U64    acc = 0; /* pending bits, right aligned */
+    int    bits = 0;
+    STRLEN i;
+
+    for ( i = 0; i < len; i++ ) {
+        acc   = ( acc << hpack_huffman_len[ s[i] ] ) | hpack_huffman_code[ s[i] ];
+        bits += hpack_huffman_len[ s[i] ];
+        while ( bits >= 8 ) {
+            bits -= 8;
+            *d++ = (U8) ( acc >> bits );
+        }
+    }
+
+    /* pad with the most significant bits of EOS, all ones */
+    if (bits)
+        *d++ = (U8) ( ( acc << ( 8 - bits ) ) | ( 0xff >> bits ) );
+
+    return d - start;
+}
+
+/* Decodes the Huffman coded s into d, which needs room for len * 8 / 5
+ * bytes. Returns the bytes written, or -1 when s holds EOS, isn't padded
+ * with (at most 7) one bits or ends halfway through a code. */
+static SSize_t hpack_huffman_decode(const U8 *s, STRLEN len, U8 *d) {
+    U8     *start = d;
+    U32    code = 0;
+    int    code_len = 0, bit;
+    STRLEN i;
+
+    for ( i = 0; i < len; i++ ) {
+        for ( bit = 7; bit >= 0; bit-- ) {
+            U32 offset;
+
+            code = ( code << 1 ) | ( ( s[i] >> bit ) & 1 );
+            code_len++;
+
+            offset = code - hpack_huffman_first[code_len];
+            if ( offset >= hpack_huffman_count[code_len] )
+                continue;
+
+            offset = hpack_huffman_sym[ hpack_huffman_offset[code_len] + offset ];
+            if ( offset == HPACK_HUFFMAN_EOS )
+                return -1;
+
+            *d++     = (U8) offset;
+            code     = 0;
+            code_len = 0;
+        }
+    }
+
+    if ( code_len > 7 || code != ( (U32) 1 << code_len ) - 1 )
+        return -1;
+
+    return d - start;
+}
+
+/* A dynamic table entry: name and value share one allocation */
+typedef struct {
+    char *name;
+    char *value;
+    U32  name_len;
+    U32  value_len;
+} hpack_entry_t;
+
+/* The dynamic table of one direction of a connection: a ring of entries,
+ * the oldest at start */
+typedef struct {
+    hpack_entry_t *entries;
+    U32           cap;
+    U32           start;
+    U32           count;
+    UV            size;          /* sum of the entries' sizes */
+    UV            max_size;      /* current maximum, as last signalled */
+    UV            settings_size; /* SETTINGS_HEADER_TABLE_SIZE, the upper bound */
+    UV            update_min;    /* encoder: smallest max_size since the last block */
+    bool          update;        /* encoder: a size update is due */
+    UV            max_list_size; /* decoder: SETTINGS_MAX_HEADER_LIST_SIZE, 0 for none */
+} hpack_table_t;
+
+#define hpack_entry_size(e) ( HPACK_ENTRY_OVERHEAD + (e)->name_len + (e)->value_len )
+
+/* Entry i, 1 being the newest */
+#define hpack_table_entry(t, i) \
+    ( &(t)->entries[ ( (t)->start + (t)->count - (i) ) % (t)->cap ] )
+
+static void hpack_table_evict(hpack_table_t *t, UV room) {
+    while ( t->count && t->size + room > t->max_size ) {
+        hpack_entry_t *e = &t->entries[ t->start ];
+
+        t->size -= hpack_entry_size(e);
+        Safefree(e->name);
+        t->start = ( t->start + 1 ) % t->cap;
+        t->count--;
+    }
+}
+
+/* Adds an entry, evicting as needed; one larger than the whole table
+ * simply empties it (RFC 7541, 4.4) */
+static void hpack_table_add(hpack_table_t *t, const char *name, STRLEN name_len,
+                            const char *value, STRLEN value_len) {
+    UV            size = HPACK_ENTRY_OVERHEAD + name_len + value_len;
+    hpack_entry_t *e;
+    char          *buf;
+
+    /* copied first: name may be that of an entry about to be evicted */
+    Newx(buf, name_len + value_len + 1, char);
+    Copy(name, buf, name_len, char);
+    Copy(value, buf + name_len, value_len, char);
+
+    hpack_table_evict(t, size);
+    if ( size > t->max_size ) {
+        Safefree(buf);
+        return;
+    }
+
+    if ( t->count == t->cap ) {
+        U32           cap = t->cap ? t->cap * 2 : 16, i;
+        hpack_entry_t *entries;
+
+        Newx(entries, cap, hpack_entry_t);
+        for ( i = 0; i < t->count; i++ )
+            entries[i] = t->entries[ ( t->start + i ) % t->cap ];
+        Safefree(t->entries);
+
+        t->entries = entries;
+        t->cap     = cap;
+        t->start   = 0;
+    }
+
+    e = &t->entries[ ( t->start + t->count ) % t->cap ];
+    e->name      = buf;
+    e->value     = buf + name_len;
+    e->name_len  = (U32) name_len;
+    e->value_len = (U32) value_len;
+
+    t->count++;
+    t->size += size;
+}
+
+static void hpack_table_resize(hpack_table_t *t, UV max_size) {
+    t->max_size = max_size;
+    hpack_table_evict(t, 0);
+}
+
+static void hpack_table_init(hpack_table_t *t, UV settings_size) {
+    Zero(t, 1, hpack_table_t);
+    t->max_size = t->settings_size = t->update_min = settings_size;
+    t->max_list_size = HPACK_DEFAULT_MAX_LIST_SIZE;
+}
+
+static void hpack_table_free(hpack_table_t *t) {
+    hpack_table_resize(t, 0);
+    Safefree(t->entries);
+    t->entries = NULL;
+    t->cap     = 0;
+}
+
+/* Looks name (and value) up in the dynamic table. Returns the index of a
+ * full match, or 0 with *name_index set to one matching the name only. */
+static U32 hpack_table_find(const hpack_table_t *t, const char *name, STRLEN name_len,
+                            const char *value, STRLEN value_len, U32 *name_index) {
+    U32 i;
+
+    *name_index = 0;
+    for ( i = 1; i <= t->count; i++ ) {
+        const hpack_entry_t *e = hpack_table_entry(t, i);
+
+        if ( e->name_len != name_len || memNE(e->name, name, name_len) )
+            continue;
+        if ( e->value_len == value_len && memEQ(e->value, value, value_len) )
+            return i;
+        if ( !*name_index )
+            *name_index = i;
+    }
+    return 0;
+}
+
+/* Finds index in the static table followed by t's dynamic table (t may
+ * be NULL). Returns FALSE when there's no such entry. */
+static bool hpack_lookup(const hpack_table_t *t, UV index, const char **name, STRLEN *name_len,
+                         const char **value, STRLEN *value_len) {
+    if ( index == 0 )
+        return FALSE;
+
+    if ( index <= HPACK_STATIC_COUNT ) {
+        const hpack_static_t *s = &hpack_static[index - 1];
+
+        *name      = s->name;
+        *name_len  = s->name_len;
+        *value     = s->value;
+        *value_len = s->value_len;
+        return TRUE;
+    }
+
+    index -= HPACK_STATIC_COUNT;
+    if ( t == NULL || index > t->count )
+        return FALSE;
+
+    {
+        const hpack_entry_t *e = hpack_table_entry(t, index);
+
+        *name      = e->name;
+        *name_len  = e->name_len;
+        *value     = e->value;
+        *value_len = e->value_len;
+    }
+    return TRUE;
+}
+
+#endif /* HPACK_H */
@@ -0,0 +1,235 @@
+/*
+ * Generated by tools/gen_known_headers.pl -- do not edit.
+ *
+ * Perfect hash of well-known header names: every name below lands in its
+ * own slot of known_header_slot[], so a lookup is one hash pass over the
+ * lowercased name, one displacement fetch and one memcmp().
+ */
+#ifndef KNOWN_HEADERS_H
+#define KNOWN_HEADERS_H
+
+#define KNOWN_HEADER_COUNT   120
+#define KNOWN_HEADER_SLOTS   256
+#define KNOWN_HEADER_BUCKETS 64
+#define KNOWN_HEADER_MIN_LEN 2
+#define KNOWN_HEADER_MAX_LEN 35
+
+/* as_string() rank of names missing from HTTP::Headers::Fast's %header_order */
+#define KNOWN_HEADER_NO_ORDER 999
+
+typedef struct {
+    const char     *name;      /* lowercased, as used for object keys */
+    const char     *canonical; /* %standard_case value seeded at boot, or NULL */
+    unsigned char  len;
+    unsigned short order;      /* %header_order rank */
+} known_header_t;
+
+static const known_header_t known_headers[KNOWN_HEADER_COUNT] = {
+    { "cache-control",                       "Cache-Control",                       13,   1 },
+    { "connection",                          "Connection",                          10,   2 },
+    { "date",                                "Date",                                 4,   3 },
+    { "pragma",                              "Pragma",                               6,   4 },
+    { "trailer",                             "Trailer",                              7,   5 },
+    { "transfer-encoding",                   "Transfer-Encoding",                   17,   6 },
+    { "upgrade",                             "Upgrade",                              7,   7 },
+    { "via",                                 "Via",                                  3,   8 },
+    { "warning",                             "Warning",                              7,   9 },
+    { "accept",                              "Accept",                               6,  10 },
+    { "accept-charset",                      "Accept-Charset",                      14,  11 },
+    { "accept-encoding",                     "Accept-Encoding",                     15,  12 },
+    { "accept-language",                     "Accept-Language",                     15,  13 },
+    { "authorization",                       "Authorization",                       13,  14 },
+    { "expect",                              "Expect",                               6,  15 },
+    { "from",                                "From",                                 4,  16 },
+    { "host",                                "Host",                                 4,  17 },
+    { "if-match",                            "If-Match",                             8,  18 },
+    { "if-modified-since",                   "If-Modified-Since",                   17,  19 },
+    { "if-none-match",                       "If-None-Match",                       13,  20 },
+    { "if-range",                            "If-Range",                             8,  21 },
+    { "if-unmodified-since",                 "If-Unmodified-Since",                 19,  22 },
+    { "max-forwards",                        "Max-Forwards",                        12,  23 },
+    { "proxy-authorization",                 "Proxy-Authorization",                 19,  24 },
+    { "range",                               "Range",                                5,  25 },
+    { "referer",                             "Referer",                              7,  26 },
+    { "te",                                  "TE",                                   2,  27 },
+    { "user-agent",                          "User-Agent",                          10,  28 },
+    { "accept-ranges",                       "Accept-Ranges",                       13,  29 },
+    { "age",                                 "Age",                                  3,  30 },
+    { "etag",                                "ETag",                                 4,  31 },
+    { "location",                            "Location",                             8,  32 },
+    { "proxy-authenticate",                  "Proxy-Authenticate",                  18,  33 },
+    { "retry-after",                         "Retry-After",                         11,  34 },
+    { "server",                              "Server",                               6,  35 },
+    { "vary",                                "Vary",                                 4,  36 },
+    { "www-authenticate",                    "WWW-Authenticate",                    16,  37 },
+    { "allow",                               "Allow",                                5,  38 },
+    { "content-encoding",                    "Content-Encoding",                    16,  39 },
+    { "content-language",                    "Content-Language",                    16,  40 },
+    { "content-length",                      "Content-Length",                      14,  41 },
+    { "content-location",                    "Content-Location",                    16,  42 },
+    { "content-md5",                         "Content-MD5",                         11,  43 },
+    { "content-range",                       "Content-Range",                       13,  44 },
+    { "content-type",                        "Content-Type",                        12,  45 },
+    { "expires",                             "Expires",                              7,  46 },
+    { "last-modified",                       "Last-Modified",                       13,  47 },
+    { "a-im",                                NULL,                                   4, KNOWN_HEADER_NO_ORDER },
+    { "accept-ch",                           NULL,                                   9, KNOWN_HEADER_NO_ORDER },
+    { "accept-patch",                        NULL,                                  12, KNOWN_HEADER_NO_ORDER },
+    { "accept-post",                         NULL,                                  11, KNOWN_HEADER_NO_ORDER },
+    { "access-control-allow-credentials",    NULL,                                  32, KNOWN_HEADER_NO_ORDER },
+    { "access-control-allow-headers",        NULL,                                  28, KNOWN_HEADER_NO_ORDER },
+    { "access-control-allow-methods",        NULL,                                  28, KNOWN_HEADER_NO_ORDER },
+    { "access-control-allow-origin",         NULL,                                  27, KNOWN_HEADER_NO_ORDER },
+    { "access-control-expose-headers",       NULL,                                  29, KNOWN_HEADER_NO_ORDER },
+    { "access-control-max-age",              NULL,                                  22, KNOWN_HEADER_NO_ORDER },
+    { "access-control-request-headers",      NULL,                                  30, KNOWN_HEADER_NO_ORDER },
+    { "access-control-request-method",       NULL,                                  29, KNOWN_HEADER_NO_ORDER },
+    { "alpn",                                NULL,                                   4, KNOWN_HEADER_NO_ORDER },
+    { "alt-svc",                             NULL,                                   7, KNOWN_HEADER_NO_ORDER },
+    { "alt-used",                            NULL,                                   8, KNOWN_HEADER_NO_ORDER },
+    { "authentication-info",                 NULL,                                  19, KNOWN_HEADER_NO_ORDER },
+    { "cache-status",                        NULL,                                  12, KNOWN_HEADER_NO_ORDER },
+    { "cdn-cache-control",                   NULL,                                  17, KNOWN_HEADER_NO_ORDER },
+    { "clear-site-data",                     NULL,                                  15, KNOWN_HEADER_NO_ORDER },
+    { "content-digest",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "content-disposition",                 NULL,                                  19, KNOWN_HEADER_NO_ORDER },
+    { "content-security-policy",             NULL,                                  23, KNOWN_HEADER_NO_ORDER },
+    { "content-security-policy-report-only", NULL,                                  35, KNOWN_HEADER_NO_ORDER },
+    { "cookie",                              NULL,                                   6, KNOWN_HEADER_NO_ORDER },
+    { "cross-origin-embedder-policy",        NULL,                                  28, KNOWN_HEADER_NO_ORDER },
+    { "cross-origin-opener-policy",          NULL,                                  26, KNOWN_HEADER_NO_ORDER },
+    { "cross-origin-resource-policy",        NULL,                                  28, KNOWN_HEADER_NO_ORDER },
+    { "delta-base",                          NULL,                                  10, KNOWN_HEADER_NO_ORDER },
+    { "digest",                              NULL,                                   6, KNOWN_HEADER_NO_ORDER },
+    { "early-data",                          NULL,                                  10, KNOWN_HEADER_NO_ORDER },
+    { "expect-ct",                           NULL,                                   9, KNOWN_HEADER_NO_ORDER },
+    { "forwarded",                           NULL,                                   9, KNOWN_HEADER_NO_ORDER },
+    { "http2-settings",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "im",                                  NULL,                                   2, KNOWN_HEADER_NO_ORDER },
+    { "keep-alive",                          NULL,                                  10, KNOWN_HEADER_NO_ORDER },
+    { "link",                                NULL,                                   4, KNOWN_HEADER_NO_ORDER },
+    { "origin",                              NULL,                                   6, KNOWN_HEADER_NO_ORDER },
+    { "permissions-policy",                  NULL,                                  18, KNOWN_HEADER_NO_ORDER },
+    { "prefer",                              NULL,                                   6, KNOWN_HEADER_NO_ORDER },
+    { "preference-applied",                  NULL,                                  18, KNOWN_HEADER_NO_ORDER },
+    { "priority",                            NULL,                                   8, KNOWN_HEADER_NO_ORDER },
+    { "proxy-authentication-info",           NULL,                                  25, KNOWN_HEADER_NO_ORDER },
+    { "proxy-status",                        NULL,                                  12, KNOWN_HEADER_NO_ORDER },
+    { "purpose",                             NULL,                                   7, KNOWN_HEADER_NO_ORDER },
+    { "refresh",                             NULL,                                   7, KNOWN_HEADER_NO_ORDER },
+    { "referrer-policy",                     NULL,                                  15, KNOWN_HEADER_NO_ORDER },
+    { "repr-digest",                         NULL,                                  11, KNOWN_HEADER_NO_ORDER },
+    { "sec-fetch-dest",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "sec-fetch-mode",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "sec-fetch-site",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "sec-fetch-user",                      NULL,                                  14, KNOWN_HEADER_NO_ORDER },
+    { "sec-websocket-accept",                NULL,                                  20, KNOWN_HEADER_NO_ORDER },
+    { "sec-websocket-extensions",            NULL,                                  24, KNOWN_HEADER_NO_ORDER },
+    { "sec-websocket-key",                   NULL,                                  17, KNOWN_HEADER_NO_ORDER },
+    { "sec-websocket-protocol",              NULL,                                  22, KNOWN_HEADER_NO_ORDER },
+    { "sec-websocket-version",               NULL,                                  21, KNOWN_HEADER_NO_ORDER },
+    { "server-timing",                       NULL,                                  13, KNOWN_HEADER_NO_ORDER },
+    { "set-cookie",                          NULL,                                  10, KNOWN_HEADER_NO_ORDER },
+    { "sourcemap",                           NULL,                                   9, KNOWN_HEADER_NO_ORDER },
+    { "strict-transport-security",           NULL,                                  25, KNOWN_HEADER_NO_ORDER },
+    { "timing-allow-origin",                 NULL,                                  19, KNOWN_HEADER_NO_ORDER },
+    { "upgrade-insecure-requests",           NULL,                                  25, KNOWN_HEADER_NO_ORDER },
+    { "want-content-digest",                 NULL,                                  19, KNOWN_HEADER_NO_ORDER },
+    { "want-repr-digest",                    NULL,                                  16, KNOWN_HEADER_NO_ORDER },
+    { "x-content-type-options",              NULL,                                  22, KNOWN_HEADER_NO_ORDER },
+    { "x-frame-options",                     NULL,                                  15, KNOWN_HEADER_NO_ORDER },
+    { "dnt",                                 NULL,                                   3, KNOWN_HEADER_NO_ORDER },
+    { "x-forwarded-for",                     NULL,                                  15, KNOWN_HEADER_NO_ORDER },
+    { "x-forwarded-host",                    NULL,                                  16, KNOWN_HEADER_NO_ORDER },
+    { "x-forwarded-proto",                   NULL,                                  17, KNOWN_HEADER_NO_ORDER },
+    { "x-real-ip",                           NULL,                                   9, KNOWN_HEADER_NO_ORDER },
+    { "x-requested-with",                    NULL,                                  16, KNOWN_HEADER_NO_ORDER },
+    { "x-xss-protection",                    NULL,                                  16, KNOWN_HEADER_NO_ORDER },
+};
+
+static const unsigned short known_header_disp[KNOWN_HEADER_BUCKETS] = {
+    0, 0, 1, 0, 0, 0, 0, 0,
+    0, 1, 0, 1, 1, 1, 2, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 2, 4, 1, 0, 0, 3,
+    7, 0, 0, 0, 0, 1, 0, 1,
+    2, 1, 2, 1, 0, 0, 10, 0,
+    0, 2, 9, 0, 8, 0, 0, 2,
+    2, 2, 0, 0, 0, 0, 2, 0,
+};
+
+static const short known_header_slot[KNOWN_HEADER_SLOTS] = {
+      0,  -1,  28,   1,  34,  47,  48,  49,  -1,  42,  -1, 103,  63,  58,  -1,  -1,
+     -1,  97,  -1, 117,   4,  -1,  -1,   5,  16,  90,  -1,  -1, 107,  -1,  46,  -1,
+     51,  -1,  23,  20,  50,  -1,  -1,  17,  -1,  32,  22,  29,  19,  -1,  -1,  -1,
+     -1,  59, 108, 113,  -1,  -1,  -1,  12,  71,  62,  -1,  -1, 114,  -1,  98,  -1,
+     -1,  -1,  -1,  -1,  -1,  80,  -1,  75,  31,  35,  26,  -1,  -1,  -1, 102,  -1,
+     37,  -1,  -1,  96, 100,  -1,  -1, 101,  76,  -1, 105,  -1,  -1, 106,  84,  25,
+    111,  -1, 110,  -1,  72,  -1, 104,   6,  -1,  -1,  -1,  -1,  -1,  -1,   7,  -1,
+     -1,  -1,   2,  -1,  45,  -1,  53,  -1,  -1,  78,  40,  94,  41,  73,  -1,  -1,
+     67,  -1,  85,  15,  -1,  92,  -1,  -1,  -1,  39,   3,  -1,  57,  -1,  -1,  -1,
+     -1,  -1,  33,  70,  -1,  -1,  -1,  -1,  -1,  -1,  83,  -1,  -1,  -1,  56,  -1,
+     -1,  -1,  81,  -1,  86,  -1,  -1,  55,  -1, 115,  82,   9,  69,  -1,  -1,  44,
+     -1,  -1,  -1, 119,  54,  10,  -1,  -1,  -1,  -1,  -1,  -1,  30,  -1,  -1,  21,
+     11,  -1,  -1,  -1,  -1,  -1,  -1, 118, 112,  93,  -1,  52,  91,  -1, 116,  -1,
+     65,  24,  -1,  95,  -1,  -1,  79, 109,  87,  99,  -1,  60,  -1,  68,  66,  -1,
+     88,  -1,  89,  -1,  -1,  -1,  64,  74,  18,  14,  38,  -1,  -1,  -1,  -1,  77,
+     -1,  -1,  -1,  -1,  -1,   8,  -1,  13,  -1,  -1,  27,  43,  36,  -1,  61,  -1,
+};
+
+/* Bit i is set when remove_content_headers() takes known_headers[i] */
+static const unsigned char known_header_content[(KNOWN_HEADER_COUNT + 7) / 8] = {
+    0x00, 0x00, 0x00, 0x00, 0xe0, 0x7f, 0x00, 0x00,
+    0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static U32 known_header_hash(const char *name, STRLEN len) {
+    U32    h = 0x811c9dc5;
+    STRLEN i;
+
+    for ( i = 0; i < len; i++ ) {
+        h ^= (unsigned char) name[i];
+        h *= 16777619;
+    }
+    return h;
+}
+
+/* Returns the index into known_headers[] of a lowercased name, or -1 */
+static int known_header_lookup(const char *name, STRLEN len) {
+    U32 h;
+    int i;
+
+    if ( len < KNOWN_HEADER_MIN_LEN || len > KNOWN_HEADER_MAX_LEN )
+        return -1;
+
+    h = known_header_hash(name, len);
+    h = ( h ^ known_header_disp[h % KNOWN_HEADER_BUCKETS] ) * 0x9E3779B1U;
+    i = known_header_slot[ h >> (32 - 8) ];
+
+    if ( i < 0 || known_headers[i].len != len
+      || memcmp(known_headers[i].name, name, len) != 0 )
+        return -1;
+
+    return i;
+}
+
+/* Returns the %header_order rank of an object key, as _sorted_field_names() uses it */
+static int known_header_order(const char *name, STRLEN len) {
+    int i = known_header_lookup(name, len);
+
+    return i < 0 ? KNOWN_HEADER_NO_ORDER : known_headers[i].order;
+}
+
+/* Whether remove_content_headers() takes an object key: an entity header,
+ * or any name starting with "content-" */
+static int known_header_is_content(const char *name, STRLEN len) {
+    int i;
+
+    if ( len >= 8 && memcmp(name, "content-", 8) == 0 )
+        return 1;
+
+    i = known_header_lookup(name, len);
+    return i >= 0 && ( known_header_content[i >> 3] >> ( i & 7 ) & 1 );
+}
+
+#endif /* KNOWN_HEADERS_H */
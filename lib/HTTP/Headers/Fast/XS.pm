@@ -20,6 +20,150 @@ XSLoader::load( 'HTTP::Headers::Fast::XS', $VERSION );
 
 *HTTP::Headers::Fast::_header_set = *HTTP::Headers::Fast::XS::_header_set;
 
+*HTTP::Headers::Fast::get_many = *HTTP::Headers::Fast::XS::get_many;
+
+*HTTP::Headers::Fast::get_many_hashref = *HTTP::Headers::Fast::XS::get_many_hashref;
+
+*HTTP::Headers::Fast::remove_header = *HTTP::Headers::Fast::XS::remove_header;
+
+*HTTP::Headers::Fast::clone = *HTTP::Headers::Fast::XS::clone;
+
+*HTTP::Headers::Fast::remove_content_headers =
+    *HTTP::Headers::Fast::XS::remove_content_headers;
+
+*HTTP::Headers::Fast::as_string = *HTTP::Headers::Fast::XS::as_string;
+
+*HTTP::Headers::Fast::append_to = *HTTP::Headers::Fast::XS::append_to;
+
+*HTTP::Headers::Fast::scan = *HTTP::Headers::Fast::XS::scan;
+
+*HTTP::Headers::Fast::header_field_names = *HTTP::Headers::Fast::XS::header_field_names;
+
+*HTTP::Headers::Fast::iter = *HTTP::Headers::Fast::XS::iter;
+
+*HTTP::Headers::Fast::as_string_without_sort =
+    *HTTP::Headers::Fast::XS::as_string_without_sort;
+
+*HTTP::Headers::Fast::to_hpack = *HTTP::Headers::Fast::XS::to_hpack;
+
+*HTTP::Headers::Fast::from_hpack = *HTTP::Headers::Fast::XS::from_hpack;
+
+*HTTP::Headers::Fast::parse = *HTTP::Headers::Fast::XS::parse;
+
+*HTTP::Headers::Fast::to_qpack = *HTTP::Headers::Fast::XS::to_qpack;
+
+*HTTP::Headers::Fast::from_qpack = *HTTP::Headers::Fast::XS::from_qpack;
+
+*HTTP::Headers::Fast::parse_lazy = *HTTP::Headers::Fast::XS::parse_lazy;
+
+*HTTP::Headers::Fast::from_psgi_env = *HTTP::Headers::Fast::XS::from_psgi_env;
+
+# objects from parse_lazy, until they become ones of the class it was
+# called on. They inherit nothing: every method is looked up in that class
+# when it's called, through AUTOLOAD, and runs on the whole hash, except
+# for our own header(), _header_get(), _header_set(), push_header(),
+# remove_header() and the get_many() ones, which fetch fields from the raw
+# block as they go
+{
+    package HTTP::Headers::Fast::Lazy;
+
+    no strict 'refs';
+
+    my %fetches = map +( $_ => \&{"HTTP::Headers::Fast::XS::$_"} ), qw(
+        header _header_get _header_set push_header remove_header get_many get_many_hashref
+    );
+
+    sub _class {
+        my $self = shift;
+        return ( ref $self && HTTP::Headers::Fast::XS::_lazy_class($self) ) || 'HTTP::Headers::Fast';
+    }
+
+    # the class's method $name, as it is when it fetches lazily, otherwise
+    # getting the whole hash first. These call it rather than goto it: an
+    # XSUB reached through goto sees the context goto was called in.
+    sub _method {
+        my ( $self, $name ) = @_;
+        my $code = _class($self)->can($name) or return;
+
+        return $code if $fetches{$name} && $code == $fetches{$name};
+        return sub {
+            HTTP::Headers::Fast::XS::_lazy_materialize( $_[0] ) if ref $_[0];
+            &$code;
+        };
+    }
+
+    for my $name ( keys %fetches ) {
+        *{$name} = sub { &{ _method( $_[0], $name ) } };
+    }
+
+    our $AUTOLOAD;
+    sub AUTOLOAD {
+        my $name = substr( $AUTOLOAD, rindex( $AUTOLOAD, ':' ) + 1 );
+        my $code = _method( $_[0], $name ) or do {
+            require Carp;
+            Carp::croak( qq{Can't locate object method "$name" via package "} . _class( $_[0] ) . '"' );
+        };
+        goto &$code;
+    }
+
+    sub DESTROY {
+        my $code = _method( $_[0], 'DESTROY' );
+        goto &$code if $code;
+    }
+
+    sub isa {
+        my ( $self, $klass ) = @_;
+        return $klass eq __PACKAGE__ || _class($self)->isa($klass);
+    }
+
+    sub can {
+        my ( $self, $name ) = @_;
+        return _method( $self, $name );
+    }
+
+    # Storable has the class down as this one already, so the copy is
+    # blessed into the one it would have become
+    sub STORABLE_freeze {
+        my ( $self, $cloning ) = @_;
+        my $class = _class($self);
+        HTTP::Headers::Fast::XS::_lazy_materialize($self);
+        return ( $class, {%$self} );
+    }
+
+    sub STORABLE_thaw {
+        my ( $self, $cloning, $class, $fields ) = @_;
+        %$self = %$fields;
+        bless $self, $class;
+    }
+}
+
+# contexts, parsers and iterators hold a C pointer, which threads must
+# not share
+sub HTTP::Headers::Fast::XS::HPACK::CLONE_SKIP    { 1 }
+sub HTTP::Headers::Fast::XS::Parser::CLONE_SKIP   { 1 }
+sub HTTP::Headers::Fast::XS::Iterator::CLONE_SKIP { 1 }
+
+my %hints = (
+    ':const' => 'HTTP::Headers::Fast::XS/const',
+    ':ops'   => 'HTTP::Headers::Fast::XS/ops',
+);
+
+sub import {
+    my $class = shift;
+
+    for my $tag (@_) {
+        my $hint = $hints{$tag}
+            or do { require Carp; Carp::croak("Unknown import tag '$tag'") };
+        $^H{$hint} = 1;
+    }
+}
+
+sub unimport {
+    my $class = shift;
+
+    delete $^H{ $hints{$_} } for @_ ? grep( $hints{$_}, @_ ) : keys %hints;
+}
+
 1;
 
 __END__
@@ -54,18 +198,468 @@ depends on it just like you did before. It's just faster now.
 This is still B<EXPERIMENTAL> and in development. Try it out, enjoy, and use
 at your own risk.
 
+=head1 IMPORT TAGS
+
+=head2 :const
+
+    use HTTP::Headers::Fast::XS ':const';
+
+    my $type = $h->header('Content-Type');
+
+Lexically scoped. Calls to C<header>, C<_header_get> and C<push_header>
+(as methods or as functions) whose field name is a constant string get
+the standardized name computed once, at compile time, along with its
+hash; each call then skips standardizing it again. The constant itself
+is left as it is. Requires perl 5.22 or later, and is a no-op before
+that.
+
+C<no HTTP::Headers::Fast::XS ':const'> turns it off again.
+
+=head2 :ops
+
+    use HTTP::Headers::Fast::XS ':ops';
+
+    my $length = $h->header('Content-Length');
+
+Lexically scoped. Method calls to C<header>, C<_header_get>,
+C<_header_set> and C<push_header> are compiled to a custom op. Method
+resolution still happens as usual, but when it lands on the XS
+implementation, the op calls it directly, skipping the generic
+subroutine call machinery. When it lands anywhere else (a subclass that
+overrides the method, say), or under the debugger, the call goes through
+the regular path.
+
+Code compiled this way can't be deparsed by L<B::Deparse>. Requires perl
+5.22 or later, and is a no-op before that. Combines with C<:const>.
+
 =head1 METHODS
 
 Implemented methods in XS:
 
+=head2 append_to
+
+    my $response = "HTTP/1.1 200 OK\r\n";
+    $h->append_to( \$response, "\r\n" );
+    $response .= "\r\n" . $body;
+
+Appends the headers, formatted as C<as_string> formats them, to the
+string referenced by the first argument, growing it once. The optional
+second argument is the end of line (C<"\n"> by default); a true third
+argument skips sorting, as C<as_string_without_sort> does.
+
+=head2 as_string
+
+=head2 as_string_without_sort
+
+=head2 clone
+
+Copies the object without Storable, which isn't even loaded: keys share
+their strings with the original's, values are copy-on-write copies, and
+arrays of values are new arrays of those. An object holding anything
+else (a reference, an object, a tied or magical value), or whose class
+has a C<STORABLE_freeze> hook, is copied with C<Storable::dclone> as
+before.
+
+=head2 from_hpack
+
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new;   # one per connection
+    my $h   = HTTP::Headers::Fast->from_hpack( $block, $ctx );
+
+Class method. Decodes an HPACK (RFC 7541) header block, as found in
+HTTP/2 HEADERS and CONTINUATION frames put together, straight into a new
+object of the class it's called on. Fields end up as C<new> would store
+them: names standardized, a field's first value as it is and any more of
+them turning it into an array. Pseudo-header fields keep their leading
+C<:>, so C<< $h->header(':status') >> finds them.
+
+The context's dynamic table is updated as the block says. Malformed
+blocks croak with a message starting with
+C<Malformed HPACK header block>, after which the context is out of step
+with the peer's and the connection must be closed with a
+C<COMPRESSION_ERROR>. Without a context, a table that lasts for this
+block only is used.
+
+A block decoding to more than the context's L</max_header_list_size>
+croaks with a message starting with C<HPACK header list over>. The whole
+block is decoded first, so the context stays in step and only the stream
+needs refusing, with a 431 response or a C<RST_STREAM>.
+
+=head2 from_psgi_env
+
+    my $h = HTTP::Headers::Fast->from_psgi_env($env);
+
+Class method. Builds an object from the request headers in a PSGI
+environment: the C<HTTP_*> keys, without the prefix, and C<CONTENT_TYPE>
+and C<CONTENT_LENGTH>. Underscores in those keys become dashes whatever
+C<$TRANSLATE_UNDERSCORE> is, so C<HTTP_X_FORWARDED_FOR> is stored as
+C<x-forwarded-for>, with C<X-Forwarded-For> as its standard case.
+Undefined values are skipped, and the rest are copy-on-write copies of
+the environment's strings.
+
+=head2 from_qpack
+
+    my $h = HTTP::Headers::Fast->from_qpack( $field_section, $max_field_section_size );
+
+Class method. Decodes a QPACK (RFC 9204) encoded field section, as found
+in HTTP/3 HEADERS frames, into a new object, as C<from_hpack> does. Only
+the static table is supported: a field section referring to the dynamic
+table croaks, as malformed ones do, with a message starting with
+C<Malformed QPACK field section>. Peers must be told so, with a
+C<SETTINGS_QPACK_MAX_TABLE_CAPACITY> of 0.
+
+Field sections over C<$max_field_section_size> bytes, counted as
+C<SETTINGS_MAX_FIELD_SECTION_SIZE> counts them, croak with a message
+starting with C<QPACK field section over>. It defaults to 65536, as for
+L</max_header_list_size>; 0 means no limit.
+
+=head2 get_many
+
+    my ( $host, $agent, $length ) = $h->get_many( 'Host', 'User-Agent', 'Content-Length' );
+
+Returns the value of each field named, as C<header> returns it in scalar
+context, in one call: several values are joined with C<", ">, and a
+missing field gives undef, so the values line up with the names.
+
+=head2 get_many_hashref
+
+    my $values = $h->get_many_hashref( 'Host', 'User-Agent' );
+    print $values->{'User-Agent'};
+
+Like C<get_many>, but returns a hash reference keyed on the names as
+given. Missing fields have an undef value.
+
+=head2 iter
+
+    my $it = $h->iter;
+    while ( my ( $name, $value ) = $it->next ) {
+        ...
+    }
+
+Returns an iterator over the fields, see L</ITERATORS>. Fields come in
+C<as_string> order; C<< $h->iter(1) >> gives them in hash order instead,
+like C<as_string_without_sort>, which is cheaper.
+
+=head2 parse
+
+    my $h = HTTP::Headers::Fast->parse("Host: example.com\r\nAccept: */*\r\n\r\n");
+
+Class method. Parses an HTTP/1 header block (the lines after the request
+or status line) into a new object, stopping at the empty line that ends
+it, or at the end of the string. Lines may end in CRLF or a bare LF.
+
+Fields end up as C<new> would store them; whitespace around values is
+dropped, and a line starting with whitespace continues the previous
+field's value after a C<"\n">, as L<HTTP::Message> C<parse> does. Lines
+without a C<:>, bare CRs and control characters in values croak, with a
+message starting with C<Malformed header block>.
+
+Field names and values are scanned for delimiters 16 or 32 bytes at a
+time, with SSE2 or AVX2, whichever the CPU has.
+
+=head2 parse_lazy
+
+    my $h = HTTP::Headers::Fast->parse_lazy($block);
+    my $host = $h->header('Host');    # only Host becomes a perl string
+
+Class method. Like L</parse>, and croaks on the same input, but only
+records where each field's name and value are in (a copy-on-write copy of)
+C<$block>. Values become perl strings when C<header>, C<_header_get>,
+C<_header_set> or C<push_header> first asks for their field; a handler
+that reads a few fields out of a large request never builds the rest.
+
+Until then the object is blessed into C<HTTP::Headers::Fast::Lazy>, which
+C<isa> both it and the class C<parse_lazy> was called on, and whose C<can>
+finds that class's methods. Any method other than those (C<as_string>,
+C<scan>, C<clone>, C<header_field_names>, a subclass's own, one added
+later and so on, and the ones above when a subclass overrides them)
+stores every field that is left first, and so does Storable; the object
+is then an ordinary one of that class. Only C<ref> tells the difference
+before that. Code that reaches into the hash directly sees only the
+fields fetched so far; call
+C<< HTTP::Headers::Fast::XS::_lazy_materialize($h) >> before doing that.
+
 =head2 push_header
 
+=head2 remove_content_headers
+
+Removes the entity headers and any field starting with C<Content->, as
+the perl version does, moving their values to the object it returns,
+uncopied. The object is blessed into the class of the one called on,
+without calling its C<new>. Entity headers are looked up in a bitset
+over the built-in table of well-known header names, rather than a list.
+
+=head2 remove_header
+
+Removes the fields named and returns their values, as the perl version
+does; in scalar context, how many there were. The values are the ones
+that were stored, not copies.
+
+=head2 scan
+
+Calls the callback as the perl version does, in the same order, with the
+same values: array elements by alias, other values as copies. A plain
+perl sub is called through C<MULTICALL>, without setting up a new call
+frame for every value; anything else (an object overloading C<&{}>, an
+XSUB) goes through C<call_sv>.
+
+=head2 to_hpack
+
+    my $ctx   = HTTP::Headers::Fast::XS::HPACK->new;   # one per connection
+    my $block = $h->to_hpack($ctx);
+
+Returns the headers as an HPACK (RFC 7541) header block, ready to go in
+an HTTP/2 HEADERS frame. Names are sent lowercase; the pseudo-header
+fields C<:authority>, C<:method>, C<:path>, C<:scheme>, C<:status> and
+C<:protocol> come first, and any other key with a leading C<:> loses it,
+as in C<as_string>. Keys starting with C<_> are skipped, and so are
+C<Connection>, C<Keep-Alive>, C<Proxy-Connection>, C<Transfer-Encoding>
+and C<Upgrade>, which HTTP/2 doesn't allow. Multi-line values are
+unfolded; values must be byte strings.
+
+Fields are looked up in the static table and in the context's dynamic
+table, and new ones are added to the latter. C<Authorization> and
+C<Proxy-Authorization> are sent as never-indexed literals. String
+literals are Huffman coded whenever that makes them shorter.
+
+Header blocks must reach the peer in the order they were encoded with a
+given context. Without a context only the static table is used.
+
+=head2 to_qpack
+
+    my $field_section = $h->to_qpack;
+
+Returns the headers as a QPACK (RFC 9204) encoded field section, for an
+HTTP/3 HEADERS frame. Fields are picked and written as C<to_hpack> does,
+against the QPACK static table only, so the encoder stream stays empty.
+
 =head2 _header_get
 
 =head2 _header_set
 
 =head2 _standardize_field_name
 
+=head1 HPACK CONTEXTS
+
+C<HTTP::Headers::Fast::XS::HPACK> holds the dynamic table of one
+direction of an HTTP/2 connection.
+
+=head2 new
+
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new($max_table_size);
+
+The maximum table size defaults to 4096, the HTTP/2 default of
+C<SETTINGS_HEADER_TABLE_SIZE>. For decoding, it's the limit the peer's
+table size updates are held to.
+
+=head2 max_table_size
+
+    $ctx->max_table_size($peer_settings_header_table_size);
+
+Returns the maximum table size, changing it first when given an
+argument. When encoding, the change is signalled at the start of the
+next header block, as RFC 7541 requires; when decoding, it's the new
+limit.
+
+=head2 table_size
+
+Returns the size of the entries in the dynamic table, as RFC 7541
+counts it.
+
+=head2 max_header_list_size
+
+    $ctx->max_header_list_size($our_settings_max_header_list_size);
+
+Returns the most a header block may decode to, changing it first when
+given an argument. It's counted as C<SETTINGS_MAX_HEADER_LIST_SIZE> is:
+each field's name and value plus 32 bytes. HTTP/2 leaves that unlimited
+by default, but a few bytes of HPACK can refer to the same large table
+entry over and over, so it defaults to 65536 here; 0 means no limit.
+
+=head1 INCREMENTAL PARSING
+
+    my $parser = HTTP::Headers::Fast::XS::Parser->new( max_size => 16384 );
+
+    # as data arrives, after the request line
+    if ( my $h = $parser->feed($chunk) ) {
+        my $body_start = $parser->leftover;
+        ...
+        $parser->reset;    # ready for the next request
+    }
+
+C<HTTP::Headers::Fast::XS::Parser> parses a header block that arrives in
+pieces, as C<parse> parses a whole one. It keeps what it couldn't parse
+yet, and only looks at it again once a chunk brings a line end, so a
+block arriving a few bytes at a time is still scanned once.
+
+=head2 new
+
+Takes these options:
+
+=over 4
+
+=item max_size
+
+The most bytes the block can take, empty line included; 65536 by
+default, 0 for no limit.
+
+=item max_fields
+
+The most fields the block can have; 100 by default, 0 for no limit.
+
+=item class
+
+The class of the objects made, C<HTTP::Headers::Fast> by default.
+
+=back
+
+=head2 feed
+
+Adds a chunk. Returns the object once the empty line ending the block
+was fed, and undef until then. Croaks as C<parse> does on malformed
+input, and once the block goes over a limit; the parser must be
+C<reset> after that, or after it returned an object.
+
+=head2 leftover
+
+Returns what was fed after the end of the block, the start of the body,
+once C<feed> returned an object; an empty string before that.
+
+=head2 fields
+
+=head2 consumed
+
+Return the number of fields and of bytes parsed so far.
+
+=head2 reset
+
+Drops everything, to parse another block.
+
+=head1 ITERATORS
+
+C<HTTP::Headers::Fast::XS::Iterator> objects, made by L</iter>, walk the
+headers one value at a time, as C<scan> would call its callback. Each
+keeps a reference to the object it walks. In sorted order the field names
+are copied and sorted once, on the first C<next>; in hash order they are
+not copied at all.
+
+Fields added or deleted while iterating are fine: in sorted order deleted
+fields are skipped, and once the object has grown the names are sorted
+again and the iterator goes on from the last name it gave, so new fields
+after it come up too (unless as many were deleted between two calls).
+Hash order is left to the hash, as with C<each>: deleting the field just
+returned is fine, but fields added meanwhile may be missed or come up
+twice.
+
+=head2 next
+
+Returns the next field's name, standardized as C<as_string> has it, and
+value, or an empty list once there are none left. A field with several
+values comes up once for each. In scalar context, returns just the name.
+
+=head2 reset
+
+Starts over from the first field.
+
+=head1 FUNCTIONS
+
+=head2 standard_case_cache_limit
+
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(1000);
+
+Every field name other than HTTP::Headers::Fast's own (C<Content-Type>,
+C<ETag> and the rest of its C<@header_order>) gets an entry in
+C<%HTTP::Headers::Fast::standard_case> the first time it is seen, spelled
+as it was then, as the perl version does. To keep
+a worker fed with arbitrary client headers from growing without bound,
+the number of such entries is capped; once the cap is reached, a
+random one is evicted for each new name.
+
+C<as_string>, C<scan>, C<iter> and C<header_field_names> name a field
+whose entry was evicted by its key title-cased again (C<X-Foo> for
+C<x-foo>), as it was first stored, so eviction only loses capitals
+inside words: a name first seen as C<X-XSS-Protection> comes out as
+C<X-Xss-Protection> until it's standardized again by C<header>,
+C<push_header> and the like. Once anything has been evicted, keys set
+straight into the hash, which have no entry either, are title-cased the
+same way; until then they print as they are, as with the perl version.
+
+Returns the current limit, setting it first when given an argument.
+Defaults to 10000; C<0> means unbounded.
+
+=head2 memoize_as_string
+
+    HTTP::Headers::Fast::XS::memoize_as_string($h);     # on
+    HTTP::Headers::Fast::XS::memoize_as_string($h, 0);  # off
+
+Makes C<$h> keep the string C<as_string> (or C<as_string_without_sort>,
+or C<append_to>) last built, and hand out copy-on-write copies of it for
+as long as C<$h> stays unchanged, with the same end of line and sort
+order asked for.
+
+Changes through the XS methods drop it, and so do values set or deleted
+from perl (C<< $h->{'content-type'} = ... >>, as some
+L<HTTP::Headers::Fast> methods do), keys added or deleted from perl, and
+elements pushed onto or removed from the array holding a field's values.
+The last few are caught by a checksum of the keys and value SVs, which
+makes C<as_string> on a memoized object a walk over the hash, but no
+more. Changes that are B<not> noticed: changes to
+C<%HTTP::Headers::Fast::standard_case> other than our own, and objects
+used as values stringifying differently.
+
+=head2 parse_many
+
+    my $objects = HTTP::Headers::Fast::XS::parse_many( \@blocks );
+    my $hosts   = HTTP::Headers::Fast::XS::parse_many( \@blocks, [ 'Host', 'User-Agent' ] );
+
+Parses every header block in C<@blocks> as L</parse> does, in one call,
+and returns a reference to an array of C<HTTP::Headers::Fast> objects in
+the same order. With a second array of field names, each object only
+gets those fields; the others are still checked for well-formedness, but
+their values are never copied.
+
+Croaks on the first malformed block, as C<parse> would.
+
+=head2 parse_corpus
+
+    my $objects = HTTP::Headers::Fast::XS::parse_corpus( $corpus, threads => 8, fields => ['Host'] );
+
+Like L</parse_many>, for header blocks that follow one another in a
+single string, each ending with an empty line (the last one may end with
+the string instead). C<$corpus> can be as large as memory allows, or a
+file mapped in with L<File::Map>; it isn't copied.
+
+The corpus is cut into one chunk per thread at block boundaries, and
+worker threads tokenize them, checking every line and recording where
+the fields asked for are, without going near perl. The calling thread
+then turns those into objects, in corpus order. Options:
+
+=over 4
+
+=item threads
+
+How many threads to use, 1 to 64. Defaults to the number of online CPUs,
+but no more than one per 64KB of corpus. Without pthreads (on Windows)
+the calling thread does all the work.
+
+=item fields
+
+An array of field names: each object only gets those, and nothing is
+copied out of the corpus for the others. Building objects is serial, so
+this is what lets the work scale with threads.
+
+=back
+
+Croaks on the first malformed block, as C<parse> would.
+
+=head2 standard_case_cache_stats
+
+    my $stats = HTTP::Headers::Fast::XS::standard_case_cache_stats();
+
+Returns a hash reference with the cache's C<size> and C<limit>, and
+counters for HTTP::Headers::Fast's own names, resolved from the built-in
+table (C<known>), for names from
+the cache (C<hits>), added to it (C<misses>) and C<evictions>.
+
 =head1 CREDITS
 
 =over 4
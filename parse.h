@@ -0,0 +1,256 @@
+/*
+ * Delimiter scanning for the header block parser, in the picohttpparser
+ * manner: find where a field name or a field value ends, 16 or 32 bytes
+ * at a time.
+ *
+ * parse_name_end(p, end) returns the first byte at or after p that is a
+ * ':', a space, a control character or DEL; parse_value_end(p, end) the
+ * first control character other than HTAB, or DEL. Either returns end
+ * when there is none. parse_next() builds the line grammar on them.
+ *
+ * As in fold.h, parse_init() picks AVX2 when the CPU has it, SSE2 is used
+ * on any other x86-64 and plain C everywhere else, and nothing here
+ * depends on perl.
+ */
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(_M_X64))
+#  define PARSE_HAVE_SSE2 1
+#  include <emmintrin.h>
+#  if defined(__clang__) || __GNUC__ >= 5
+#    define PARSE_HAVE_AVX2 1
+#    include <immintrin.h>
+#  endif
+#endif
+
+typedef const char *(*parse_scan_fn)(const char *p, const char *end);
+
+#define PARSE_NAME_STOP(c)  ( (unsigned char) (c) <= 0x20 || (c) == ':' || (c) == 0x7f )
+#define PARSE_VALUE_STOP(c) ( ( (unsigned char) (c) < 0x20 && (c) != '\t' ) || (c) == 0x7f )
+
+static const char *parse_name_end_scalar(const char *p, const char *end) {
+    while ( p < end && !PARSE_NAME_STOP(*p) )
+        p++;
+    return p;
+}
+
+static const char *parse_value_end_scalar(const char *p, const char *end) {
+    while ( p < end && !PARSE_VALUE_STOP(*p) )
+        p++;
+    return p;
+}
+
+#ifdef PARSE_HAVE_SSE2
+
+/* v <= max, comparing bytes as unsigned */
+#define PARSE_LE_SSE2(v, max) _mm_cmpeq_epi8( _mm_min_epu8((v), _mm_set1_epi8(max)), (v) )
+
+static const char *parse_name_end_sse2(const char *p, const char *end) {
+    for ( ; end - p >= 16; p += 16 ) {
+        __m128i v    = _mm_loadu_si128( (const __m128i *) p );
+        __m128i stop = _mm_or_si128(
+            PARSE_LE_SSE2(v, 0x20),
+            _mm_or_si128( _mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)) )
+        );
+        int mask = _mm_movemask_epi8(stop);
+
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return parse_name_end_scalar(p, end);
+}
+
+static const char *parse_value_end_sse2(const char *p, const char *end) {
+    for ( ; end - p >= 16; p += 16 ) {
+        __m128i v    = _mm_loadu_si128( (const __m128i *) p );
+        __m128i stop = _mm_or_si128(
+            _mm_andnot_si128( _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), PARSE_LE_SSE2(v, 0x1f) ),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f))
+        );
+        int mask = _mm_movemask_epi8(stop);
+
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return parse_value_end_scalar(p, end);
+}
+
+#endif /* PARSE_HAVE_SSE2 */
+
+#ifdef PARSE_HAVE_AVX2
+
+#define PARSE_LE_AVX2(v, max) _mm256_cmpeq_epi8( _mm256_min_epu8((v), _mm256_set1_epi8(max)), (v) )
+
+/* names are mostly shorter than a vector: the rest goes to SSE2 */
+__attribute__((target("avx2")))
+static const char *parse_name_end_avx2(const char *p, const char *end) {
+    for ( ; end - p >= 32; p += 32 ) {
+        __m256i v    = _mm256_loadu_si256( (const __m256i *) p );
+        __m256i stop = _mm256_or_si256(
+            PARSE_LE_AVX2(v, 0x20),
+            _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)) )
+        );
+        unsigned mask = (unsigned) _mm256_movemask_epi8(stop);
+
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return parse_name_end_sse2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *parse_value_end_avx2(const char *p, const char *end) {
+    for ( ; end - p >= 32; p += 32 ) {
+        __m256i v    = _mm256_loadu_si256( (const __m256i *) p );
+        __m256i stop = _mm256_or_si256(
+            _mm256_andnot_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')), PARSE_LE_AVX2(v, 0x1f) ),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f))
+        );
+        unsigned mask = (unsigned) _mm256_movemask_epi8(stop);
+
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return parse_value_end_sse2(p, end);
+}
+
+#endif /* PARSE_HAVE_AVX2 */
+
+#if defined(PARSE_HAVE_SSE2)
+static parse_scan_fn parse_name_end  = parse_name_end_sse2;
+static parse_scan_fn parse_value_end = parse_value_end_sse2;
+#else
+static parse_scan_fn parse_name_end  = parse_name_end_scalar;
+static parse_scan_fn parse_value_end = parse_value_end_scalar;
+#endif
+
+#define PARSE_IS_WS(c) ( (c) == ' ' || (c) == '\t' )
+
+/* What parse_next() found */
+#define PARSE_FIELD 0 /* a field, in *field */
+#define PARSE_END   1 /* the empty line that ends the block */
+#define PARSE_MORE  2 /* the rest of the field isn't there yet */
+#define PARSE_ERROR 3 /* a malformed line: *why says how, *line where */
+
+typedef struct {
+    const char *name;
+    size_t     name_len;
+    const char *value;     /* without surrounding whitespace */
+    size_t     value_len;  /* up to the end of the last continuation line */
+    int        folded;     /* the value has continuation lines */
+} parse_field_t;
+
+/* Returns the start of the line after the one whose content ends at q,
+ * or NULL when it isn't all there yet or, setting *why, doesn't end in
+ * LF or CRLF. At eof, the end of the buffer ends the line as well. */
+static const char *parse_eol(const char *q, const char *end, int eof, const char **why) {
+    if ( q == end )
+        return eof ? end : NULL;
+    if ( *q == '\n' )
+        return q + 1;
+    if ( *q == '\r' ) {
+        if ( q + 1 == end )
+            return eof ? end : NULL;
+        if ( q[1] == '\n' )
+            return q + 2;
+        *why = "CR without LF";
+        return NULL;
+    }
+    *why = "control character";
+    return NULL;
+}
+
+/* Parses the field (or the empty line) at *s, moving *s past it unless
+ * it's PARSE_MORE or PARSE_ERROR. A field is only complete once the line
+ * after it starts, since that could continue it, or at eof. */
+static int parse_next(const char **s, const char *end, int eof, parse_field_t *field,
+                      const char **why, const char **line) {
+    const char *n, *v, *q, *e;
+
+    *why  = NULL;
+    *line = *s;
+
+    /* the empty line */
+    if ( **s == '\r' || **s == '\n' ) {
+        if ( ( e = parse_eol(*s, end, eof, why) ) == NULL )
+            return *why ? PARSE_ERROR : PARSE_MORE;
+        *s = e;
+        return PARSE_END;
+    }
+
+    if ( PARSE_IS_WS(**s) ) {
+        *why = "continuation without a field";
+        return PARSE_ERROR;
+    }
+
+    /* name, optional whitespace, ':' */
+    n = parse_name_end(*s, end);
+    for ( v = n; v < end && PARSE_IS_WS(*v); v++ )
+        ;
+    if ( v == end ) {
+        if ( !eof )
+            return PARSE_MORE;
+        *why = "no ':'";
+        return PARSE_ERROR;
+    }
+    if ( *v != ':' || n == *s ) {
+        *why = n == *s ? "no field name" : "no ':'";
+        return PARSE_ERROR;
+    }
+
+    /* value, without surrounding whitespace */
+    for ( v++; v < end && PARSE_IS_WS(*v); v++ )
+        ;
+    q = parse_value_end(v, end);
+    if ( ( e = parse_eol(q, end, eof, why) ) == NULL )
+        return *why ? PARSE_ERROR : PARSE_MORE;
+    while ( q > v && PARSE_IS_WS(q[-1]) )
+        q--;
+
+    field->name      = *s;
+    field->name_len  = n - *s;
+    field->value     = v;
+    field->value_len = q - v;
+    field->folded    = 0;
+
+    if ( e == end && !eof )
+        return PARSE_MORE;
+
+    /* continuation lines */
+    if ( e < end && PARSE_IS_WS(*e) ) {
+        field->folded = 1;
+        while ( e < end && PARSE_IS_WS(*e) ) {
+            const char *c = e;
+
+            *line = c;
+            q = parse_value_end(c, end);
+            if ( ( e = parse_eol(q, end, eof, why) ) == NULL )
+                return *why ? PARSE_ERROR : PARSE_MORE;
+            while ( q > c && PARSE_IS_WS(q[-1]) )
+                q--;
+        }
+        if ( e == end && !eof )
+            return PARSE_MORE;
+
+        field->value_len = q - v;
+    }
+
+    *s = e;
+    return PARSE_FIELD;
+}
+
+/* Picks the widest kernels the running CPU supports */
+static void parse_init(void) {
+#ifdef PARSE_HAVE_AVX2
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) {
+        parse_name_end  = parse_name_end_avx2;
+        parse_value_end = parse_value_end_avx2;
+    }
+#endif
+}
+
+#endif /* PARSE_H */
@@ -0,0 +1,69 @@
+use strict;
+use warnings;
+use Test::More;
+
+BEGIN {
+    use_ok('HTTP::Headers::Fast');
+    use_ok('HTTP::Headers::Fast::XS');
+}
+
+can_ok( HTTP::Headers::Fast::, 'append_to' );
+
+my $h = HTTP::Headers::Fast->new(
+    'Content-Type'   => 'text/html',
+    'X-Zebra'        => 1,
+    Connection       => 'close',
+    'Content-Length' => 3744,
+    'X-Apple'        => [ 2, 3 ],
+);
+
+{
+    my $buf = "HTTP/1.1 200 OK\r\n";
+    $h->append_to( \$buf, "\r\n" );
+    is( $buf, "HTTP/1.1 200 OK\r\n" . $h->as_string("\r\n"), 'appends sorted' );
+}
+
+{
+    my $buf = '';
+    $h->append_to( \$buf );
+    is( $buf, $h->as_string, 'default eol' );
+
+    $h->append_to( \$buf, undef, 1 );
+    is( $buf, $h->as_string . $h->as_string_without_sort, 'without sort' );
+}
+
+{
+    my $buf;
+    $h->append_to( \$buf, "\n" );
+    is( $buf, $h->as_string, 'undef buffer' );
+}
+
+{
+    my $buf = 42;
+    HTTP::Headers::Fast->new( Foo => 1 )->append_to( \$buf );
+    is( $buf, "42Foo: 1\n", 'numeric buffer' );
+}
+
+{
+    my $buf = "\x{2603} ";
+    HTTP::Headers::Fast->new( Foo => "caf\x{e9}" )->append_to( \$buf );
+    is( $buf, "\x{2603} Foo: caf\x{e9}\n", 'character string buffer' );
+
+    $buf = "caf\x{e9} ";
+    HTTP::Headers::Fast->new( Foo => "\x{2603}" )->append_to( \$buf );
+    is( $buf, "caf\x{e9} Foo: \x{2603}\n", 'character string header' );
+}
+
+{
+    my $buf = '';
+    HTTP::Headers::Fast->new->append_to( \$buf );
+    is( $buf, '', 'nothing to append' );
+}
+
+ok( !eval { $h->append_to('nope'); 1 }, 'needs a scalar reference' );
+like( $@, qr/^Usage/, 'with a usage message' );
+
+ok( !eval { $h->append_to( \'constant' ); 1 }, 'read-only buffer' );
+like( $@, qr/read-only/, 'croaks' );
+
+done_testing;
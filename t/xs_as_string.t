@@ -0,0 +1,149 @@
+use strict;
+use warnings;
+use Test::More;
+
+BEGIN {
+    use_ok('HTTP::Headers::Fast');
+    use_ok('HTTP::Headers::Fast::XS');
+}
+
+can_ok( HTTP::Headers::Fast::, qw( as_string as_string_without_sort ) );
+
+# what HTTP::Headers::Fast does in perl
+my $i = 0;
+my %header_order = map { lc($_) => ++$i } qw(
+    Cache-Control Connection Date Pragma Trailer Transfer-Encoding Upgrade
+    Via Warning Accept Accept-Charset Accept-Encoding Accept-Language
+    Authorization Expect From Host If-Match If-Modified-Since If-None-Match
+    If-Range If-Unmodified-Since Max-Forwards Proxy-Authorization Range
+    Referer TE User-Agent Accept-Ranges Age ETag Location Proxy-Authenticate
+    Retry-After Server Vary WWW-Authenticate Allow Content-Encoding
+    Content-Language Content-Length Content-Location Content-MD5
+    Content-Range Content-Type Expires Last-Modified
+);
+
+sub process_newline {
+    local $_ = shift;
+    my $endl = shift;
+    s/\s+$//;
+    s/\n(\x0d?\n)+/\n/g;
+    s/\n([^\040\t])/\n $1/g;
+    s/\n/$endl/g;
+    $_;
+}
+
+sub reference {
+    my ( $h, $endl, $sorted ) = @_;
+    $endl = "\n" unless defined $endl;
+
+    my @keys = keys %$h;
+    @keys = sort {
+        ( $header_order{$a} || 999 ) <=> ( $header_order{$b} || 999 )
+          || $a cmp $b
+    } @keys if $sorted;
+
+    my @result;
+    for my $key (@keys) {
+        next if index( $key, '_' ) == 0;
+        my $vals = $h->{$key};
+        for my $val ( ref($vals) eq 'ARRAY' ? @$vals : $vals ) {
+            my $field = $HTTP::Headers::Fast::standard_case{$key} || $key;
+            $field =~ s/^://;
+            $val = process_newline( $val, $endl ) if index( $val, "\n" ) >= 0;
+            push @result, $field . ': ' . $val;
+        }
+    }
+    join( $endl, @result, '' );
+}
+
+sub same {
+    my ( $h, $name, @endl ) = @_;
+    is( $h->as_string(@endl), reference( $h, $endl[0], 1 ), "$name: as_string" );
+    is(
+        $h->as_string_without_sort(@endl),
+        reference( $h, $endl[0], 0 ),
+        "$name: as_string_without_sort",
+    );
+}
+
+{
+    package Stringy;
+    use overload '""' => sub { 'stringy' }, fallback => 1;
+}
+
+my $h = HTTP::Headers::Fast->new;
+same( $h, 'empty' );
+
+$h = HTTP::Headers::Fast->new(
+    'Content-Type'   => 'text/html',
+    Date             => 'Tue, 11 Nov 2008 01:16:37 GMT',
+    'X-Zebra'        => 1,
+    'X-Apple'        => [ 2, 3 ],
+    Connection       => 'close',
+    'Content-Length' => 3744,
+    Accept           => [qw( text/html text/plain )],
+    ETag             => '"abc"',
+);
+same( $h, 'mixed' );
+same( $h, 'mixed, CRLF', "\r\n" );
+same( $h, 'mixed, undef eol', undef );
+same( $h, 'mixed, long eol', "<<--EOL-->>\n" );
+
+$h->{_private}   = 'hidden';
+$h->{':status'}  = 200;
+$h->{'Raw-Case'} = 'poked';
+$h->{'x-obj'}    = bless( {}, 'Stringy' );
+$h->{'x-blessed-array'} = bless( [], 'Stringy' );
+same( $h, 'odd keys' );
+
+$h = HTTP::Headers::Fast->new(
+    Foo => "a\n\n\r\nb\nc\n \td\n  ",
+    Bar => "\nstarts with newline",
+    Baz => [ "x\ny", "z\r\n\r\n" ],
+);
+same( $h, 'newlines' );
+same( $h, 'newlines, CRLF', "\r\n" );
+
+$h = HTTP::Headers::Fast->new(
+    Foo => "caf\x{e9}",
+    Bar => "snow \x{2603}",
+    Baz => "multi\nline \x{2603}\x{a0}",
+);
+same( $h, 'character strings' );
+same( $h, 'character eol', "\x{2028}" );
+
+{
+    local $HTTP::Headers::Fast::standard_case{'x-custom'} = 'X-CUSTOM';
+    $h = HTTP::Headers::Fast->new;
+    $h->{'x-custom'} = 1;
+    is( $h->as_string, "X-CUSTOM: 1\n", 'uses %standard_case' );
+}
+
+{
+    # names in the built-in table that HTTP::Headers::Fast has no
+    # spelling of its own for print the same with the XS module loaded
+    my $code = q{
+        my $h = HTTP::Headers::Fast->new( map { ( $_ => 1 ) } @ARGV );
+        print $h->as_string, join( ',', $h->header_field_names );
+    };
+    my @names = qw( sec-websocket-key dnt a-im accept-ch x-real-ip Sec-WebSocket-Version X-XSS-Protection etag );
+    my $h     = HTTP::Headers::Fast->new( map { ( $_ => 1 ) } @names );
+    my $perl  = do {
+        open my $fh, '-|', $^X, ( map {"-I$_"} grep { !ref } @INC ), '-MHTTP::Headers::Fast', '-e', $code, @names
+            or die "can't run $^X: $!";
+        local $/;
+        <$fh>;
+    };
+    is( $h->as_string . join( ',', $h->header_field_names ), $perl, 'well-known names as the perl version spells them' );
+    like( $perl, qr/^Dnt: 1\nSec-Websocket-Key: 1\n/m, 'which title-cases them' );
+    like( $perl, qr/^Sec-WebSocket-Version: 1\n/m, 'or keeps their first spelling' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => "\x{2603}" );
+    my $s = $h->as_string;
+    ok( utf8::is_utf8($s), 'character string result' );
+    is( $s, "Foo: \x{2603}\n", 'and right' );
+}
+
+done_testing;
@@ -0,0 +1,127 @@
+use strict;
+use warnings;
+use Test::More;
+
+BEGIN {
+    use_ok('HTTP::Headers::Fast');
+    use_ok('HTTP::Headers::Fast::XS');
+}
+
+sub fresh {
+    my $h = shift;
+    my $copy = bless { %$h }, ref $h;
+    return $copy->as_string(@_);
+}
+
+my $h = HTTP::Headers::Fast->new(
+    'Content-Type' => 'text/html',
+    'X-Apple'      => [ 1, 2 ],
+    Date           => 'Tue, 11 Nov 2008 01:16:37 GMT',
+);
+HTTP::Headers::Fast::XS::memoize_as_string($h);
+
+my $str = $h->as_string;
+is( $str, fresh($h), 'memoized object serializes as usual' );
+is( $h->as_string, $str, 'and again' );
+is( $h->as_string("\r\n"), fresh( $h, "\r\n" ), 'other eol' );
+is( $h->as_string, $str, 'back to the default eol' );
+is(
+    join( '', sort split /^/, $h->as_string_without_sort ),
+    join( '', sort split /^/, $str ),
+    'without sort',
+);
+
+{
+    my $buf = 'x';
+    $h->append_to( \$buf );
+    is( $buf, "x$str", 'append_to' );
+}
+
+# XS mutators
+$h->header( 'Content-Type' => 'text/plain' );
+like( $h->as_string, qr{Content-Type: text/plain}, 'header set' );
+$h->push_header( 'X-Apple' => 3 );
+like( $h->as_string, qr{X-Apple: 3}, 'push_header' );
+$h->_header_set( 'X-Apple' => 4 );
+like( $h->as_string, qr{X-Apple: 4}, '_header_set' );
+$h->header( Date => undef, Foo => 'bar' );
+unlike( $h->as_string, qr{Date}, 'header set with several fields' );
+
+# from perl
+$h->as_string;
+$h->{'content-type'} = 'image/png';
+like( $h->as_string, qr{Content-Type: image/png}, 'value set from perl' );
+
+$h->{'x-apple'} = [ 5, 6 ];
+$h->as_string;
+$h->{'x-apple'}[1] = 7;
+like( $h->as_string, qr{X-Apple: 7}, 'array element set from perl' );
+
+delete $h->{foo};
+$h->{bar} = 1;
+is( $h->as_string, fresh($h), 'key deleted and another added from perl' );
+
+$h->{baz} = 2;
+is( $h->as_string, fresh($h), 'key added from perl' );
+
+{
+    my $h = HTTP::Headers::Fast->new( C => 'x', A => 1 );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    $h->as_string;
+    my $r = \$h->{c};
+    delete $h->{c};
+    $h->{d} = 'z';
+    is( $h->as_string, fresh($h), 'key deleted while its value is held, and another added' );
+
+    my $v = \$h->{d};
+    delete $h->{d};
+    $h->{d} = 'y';
+    is( $h->as_string, fresh($h), 'same key deleted while held, and added back' );
+
+    $h->{foo} = [ 1, 2 ];
+    $h->as_string;
+    push @{ $h->{foo} }, 3;
+    like( $h->as_string, qr/^Foo: 3$/m, 'pushed onto an array from perl' );
+    pop @{ $h->{foo} };
+    unlike( $h->as_string, qr/^Foo: 3$/m, 'popped off it' );
+    is( $h->as_string, fresh($h), 'and as_string is right' );
+}
+
+{
+    my $limit = HTTP::Headers::Fast::XS::standard_case_cache_limit();
+    my $h = HTTP::Headers::Fast->new( 'X-Memo-Case' => 1 );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    is( $h->as_string, "X-Memo-Case: 1\n", 'before eviction' );
+
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(1);
+    HTTP::Headers::Fast->new( "X-Memo-Other-$_" => 1 ) for 1 .. 3;
+    is( $h->as_string, fresh($h), 'after eviction' );
+    HTTP::Headers::Fast::XS::standard_case_cache_limit($limit);
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => 1 );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    $h->as_string;
+    HTTP::Headers::Fast::XS::memoize_as_string( $h, 0 );
+    $h->{foo} = 2;
+    is( $h->as_string, "Foo: 2\n", 'turned off' );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    is( $h->as_string, "Foo: 2\n", 'and on again' );
+    $h->{foo} = 3;
+    is( $h->as_string, "Foo: 3\n", 'still watching values' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => 1 );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    $h->as_string;
+    my $ref = \$h->{foo};
+    undef $h;
+    $$ref = 2;
+    is( $$ref, 2, 'values outlive their object' );
+}
+
+ok( !eval { HTTP::Headers::Fast::XS::memoize_as_string('nope'); 1 }, 'needs an object' );
+
+done_testing;
@@ -0,0 +1,97 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+{
+    my $h = HTTP::Headers::Fast->new(
+        Foo              => [ 1, 2, 3 ],
+        Bar              => 'x',
+        'Content-Length' => 12,
+        'X-Float'        => 1.5,
+        'X-Empty'        => [],
+    );
+    $h->{':authority'} = 'example.com';
+    $h->{_private}     = undef;
+    $h->{"x-\x{263a}"} = "\x{263a}";
+
+    $h->as_string;
+    my $c = $h->clone;
+
+    isa_ok( $c, 'HTTP::Headers::Fast' );
+    isnt( $c, $h, 'a new object' );
+    is_deeply( {%$c}, {%$h}, 'with the same fields' );
+    is( $c->as_string, $h->as_string, 'and the same as_string' );
+    is( $INC{'Storable.pm'}, undef, 'without loading Storable' );
+
+    push @{ $c->{foo} }, 4;
+    $c->header( Bar => 'y' );
+    is_deeply( [ $h->header('Foo') ], [ 1, 2, 3 ], 'arrays are copies' );
+    is( $h->header('Bar'), 'x', 'values are copies' );
+
+    $h->header( 'Content-Length' => 13 );
+    is( $c->header('Content-Length'), 12, 'both ways' );
+    is( $c->{"x-\x{263a}"}, "\x{263a}", 'character keys' );
+}
+
+{
+    package My::Headers;
+    our @ISA = ('HTTP::Headers::Fast');
+}
+isa_ok( My::Headers->new( Foo => 1 )->clone, 'My::Headers', 'subclass' );
+is_deeply( { %{ HTTP::Headers::Fast->new->clone } }, {}, 'no fields' );
+
+{
+    my $h = HTTP::Headers::Fast->parse_lazy("Host: example.com\r\nAccept: */*\r\n\r\n");
+    my $c = $h->clone;
+    is( ref $c, 'HTTP::Headers::Fast', 'lazy objects clone into ordinary ones' );
+    is_deeply( {%$c}, { host => 'example.com', accept => '*/*' }, 'with every field' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, 2, 3 ], Bar => 'x' );
+    HTTP::Headers::Fast::XS::memoize_as_string($h);
+    my $s = $h->as_string;
+    my $c = $h->clone;
+    is_deeply( {%$c}, {%$h}, 'memoized objects after as_string' );
+    is( $c->as_string, $s, 'print the same' );
+
+    $c->{bar} = 'y';
+    is( $h->as_string, $s, 'the copy is not watched for the original' );
+}
+
+is( $INC{'Storable.pm'}, undef, 'Storable is still not loaded' );
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, 2, 3 ], 'X-Obj' => bless( { a => 1 }, 'Some::Class' ) );
+    my $c = $h->clone;
+    ok( $INC{'Storable.pm'}, 'an object value falls back to Storable' );
+    isa_ok( $c->header('X-Obj'), 'Some::Class' );
+    isnt( $c->header('X-Obj'), $h->header('X-Obj'), 'deep copied' );
+    is_deeply( {%$c}, {%$h}, 'every field' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, { a => 1 } ] );
+    my $c = $h->clone;
+    is_deeply( {%$c}, {%$h}, 'so does a reference in an array' );
+    isnt( ( $c->header('Foo') )[1], ( $h->header('Foo') )[1], 'deep copied' );
+}
+
+{
+    package My::Hooked;
+    our @ISA = ('HTTP::Headers::Fast');
+    our $frozen = 0;
+    sub STORABLE_freeze { $frozen++; return ( '', {%{ $_[0] }} ) }
+    sub STORABLE_thaw { %{ $_[0] } = %{ $_[3] } }
+}
+
+{
+    my $c = My::Hooked->new( Foo => 1 )->clone;
+    is( $My::Hooked::frozen, 1, 'Storable hooks are called' );
+    is_deeply( {%$c}, { foo => 1 }, 'and used' );
+}
+
+done_testing;
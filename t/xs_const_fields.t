@@ -0,0 +1,91 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS ':const';
+
+{
+    my $h = HTTP::Headers::Fast->new( 'Content-Type' => 'text/plain' );
+
+    is( $h->header('Content-Type'), 'text/plain', 'known name' );
+    is( $h->header('content-type'), 'text/plain', 'known name, lowercase' );
+    is( $h->_header_get('CONTENT-TYPE'), 'text/plain', '_header_get' );
+    is(
+        HTTP::Headers::Fast::header( $h, 'Content-Type' ),
+        'text/plain',
+        'function call',
+    );
+
+    $h->header( 'Content-Type' => 'text/html' );
+    is( $h->header('Content-Type'), 'text/html', 'set' );
+
+    $h->push_header( 'Content-Type' => 'text/css' );
+    is_deeply( [ $h->header('Content-Type') ], [qw( text/html text/css )], 'push' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new;
+
+    $h->header( 'X-Custom-Thing' => 1 ) for 1 .. 2;
+    is( $h->as_string, "X-Custom-Thing: 1\n", 'unknown name' );
+
+    $h->header( ':raw_Name' => 2 );
+    is( $h->{':raw_Name'}, 2, 'leading colon name kept verbatim' );
+}
+
+{
+    my @names;
+    for ( 1 .. 2 ) {
+        my $name = 'X-Const-Name';
+        push @names, $name;
+        HTTP::Headers::Fast->new->header( 'X-Const-Name' => 1 );
+    }
+    is_deeply( \@names, [ ('X-Const-Name') x 2 ], 'constant left as it is' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new;
+    my $get = sub { $h->header('Foo_Bar') };
+
+    $h->header( 'foo-bar' => 'dash' );
+    $h->header( ':foo_bar' => 'underscore' );
+    $h->{foo_bar} = 'underscore';
+
+    is( $get->(), 'dash', 'translated under default TRANSLATE_UNDERSCORE' );
+    {
+        local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 0;
+        is( $get->(), 'underscore', 'not translated once turned off' );
+    }
+    is( $get->(), 'dash', 'translated again' );
+}
+
+{
+    my $limit = HTTP::Headers::Fast::XS::standard_case_cache_limit();
+    my $h     = HTTP::Headers::Fast->new;
+    my $set   = sub { $h->header( 'X-Evicted-Name' => shift ) };
+
+    $set->(1);
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(1);
+    HTTP::Headers::Fast->new->header( "X-Other-$_" => 1 ) for 1 .. 3;
+    $set->(2);
+    is(
+        $HTTP::Headers::Fast::standard_case{'x-evicted-name'},
+        'X-Evicted-Name',
+        'evicted %standard_case entry put back',
+    );
+    is( $h->as_string, "X-Evicted-Name: 2\n", 'and value set' );
+
+    HTTP::Headers::Fast::XS::standard_case_cache_limit($limit);
+}
+
+{
+    no HTTP::Headers::Fast::XS ':const';
+    my $h = HTTP::Headers::Fast->new( Foo => 1 );
+    is( $h->header('Foo'), 1, 'works with the hint turned off' );
+}
+
+eval 'use HTTP::Headers::Fast::XS ":nope"; 1';
+like( $@, qr/Unknown import tag ':nope'/, 'unknown tag croaks' );
+
+done_testing;
@@ -0,0 +1,140 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+can_ok( HTTP::Headers::Fast::, 'from_hpack' );
+
+sub decode { HTTP::Headers::Fast->from_hpack( pack( 'H*', $_[0] ), $_[1] ) }
+
+# RFC 7541, C.6: responses, Huffman coded, 256 byte table
+{
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new(256);
+    my %resp = (
+        'cache-control' => 'private',
+        date            => 'Mon, 21 Oct 2013 20:13:21 GMT',
+        location        => 'https://www.example.com',
+    );
+
+    my $h = decode(
+        '488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff'
+          . '6e919d29ad171863c78f0b97c8e9ae82ae43d3',
+        $ctx,
+    );
+    isa_ok( $h, 'HTTP::Headers::Fast' );
+    is_deeply( {%$h}, { ':status' => 302, %resp }, 'C.6.1' );
+    is( $ctx->table_size, 222, 'C.6.1 table size' );
+
+    is_deeply( { %{ decode( '4883640effc1c0bf', $ctx ) } }, { ':status' => 307, %resp }, 'C.6.2' );
+    is( $ctx->table_size, 222, 'C.6.2 table size' );
+
+    $h = decode(
+        '88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7'
+          . 'f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b10'
+          . '63d5007',
+        $ctx,
+    );
+    is_deeply(
+        {%$h},
+        {
+            ':status'          => 200,
+            %resp,
+            date               => 'Mon, 21 Oct 2013 20:13:22 GMT',
+            'content-encoding' => 'gzip',
+            'set-cookie'       => 'foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1',
+        },
+        'C.6.3',
+    );
+    is( $ctx->table_size, 215, 'C.6.3 table size' );
+    is( $h->header('Content-Encoding'), 'gzip', 'usable as any other object' );
+}
+
+{
+    # C.3.1 plus a custom field added to the table, then indexed
+    my $h = decode('828684410f7777772e6578616d706c652e636f6d400a637573746f6d2d6b65790d637573746f6d2d686561646572be');
+    is_deeply(
+        {%$h},
+        {
+            ':method'    => 'GET',
+            ':scheme'    => 'http',
+            ':path'      => '/',
+            ':authority' => 'www.example.com',
+            'custom-key' => [ ('custom-header') x 2 ],
+        },
+        'repeated fields as new() stores them, without a context',
+    );
+    is( $HTTP::Headers::Fast::standard_case{'custom-key'}, 'Custom-Key', 'names standardized' );
+}
+
+{
+    package My::Headers;
+    our @ISA = 'HTTP::Headers::Fast';
+}
+
+isa_ok( My::Headers->from_hpack( pack 'H*', '88' ), 'My::Headers', 'subclass' );
+isa_ok( HTTP::Headers::Fast->new->from_hpack( pack 'H*', '88' ), 'HTTP::Headers::Fast', 'object as invocant' );
+
+{
+    my $enc = HTTP::Headers::Fast::XS::HPACK->new;
+    my $dec = HTTP::Headers::Fast::XS::HPACK->new;
+    my $h   = HTTP::Headers::Fast->new(
+        ':status'        => 200,
+        'Content-Type'   => 'text/html; charset=utf-8',
+        'Set-Cookie'     => [qw( a=1 b=2 c=3 )],
+        'X-Long'         => 'x' x 5000,
+        Authorization    => 'Basic Zm9vOmJhcg==',
+        'X-Binary'       => join( '', map chr, 1 .. 9, 11, 12, 14 .. 255 ),
+    );
+
+    for my $round ( 1 .. 3 ) {
+        $enc->max_table_size(100) if $round == 3;
+        my $copy = HTTP::Headers::Fast->from_hpack( $h->to_hpack($enc), $dec );
+        is_deeply( {%$copy}, {%$h}, "round trip $round" );
+        is( $dec->table_size, $enc->table_size, "tables in step $round" );
+    }
+}
+
+{
+    my @bad = (
+        bf               => qr/no entry 63 in the table/,
+        80               => qr/no entry 0 in the table/,
+        '3f'             => qr/truncated or oversized integer/,
+        '8fffffffffff0f' => qr/truncated or oversized integer/,
+        '4088'           => qr/truncated string/,
+        '408525a849e95a' => qr/bad Huffman code/,
+        '4081ff'         => qr/bad Huffman code/,
+        '82203f'         => qr/table size update after a header field/,
+        '3fe21f'         => qr/table size 4097 over the 4096 limit/,
+    );
+
+    while ( my ( $hex, $error ) = splice @bad, 0, 2 ) {
+        ok( !eval { decode($hex); 1 }, "$hex croaks" );
+        like( $@, qr/^Malformed HPACK header block: $error/, 'with a message' );
+    }
+}
+
+# one 4000 byte entry added to the table, then referred to 100 times
+{
+    my $dec  = HTTP::Headers::Fast::XS::HPACK->new;
+    my $add  = "\x40\x03x-a\x7f\xa1\x1e" . 'a' x 4000;
+    my $bomb = $add . "\xbe" x 100;
+    is( $dec->max_header_list_size, 65536, 'default max header list size' );
+
+    ok( !eval { HTTP::Headers::Fast->from_hpack( $bomb, $dec ); 1 }, 'a header list over it croaks' );
+    like( $@, qr/^HPACK header list over the 65536 byte limit/, 'with a message' );
+    is( $dec->table_size, 4035, 'after decoding the whole block' );
+    is( HTTP::Headers::Fast->from_hpack( "\xbe", $dec )->header('X-A'), 'a' x 4000, 'so the table is in step' );
+
+    ok( !eval { HTTP::Headers::Fast->from_hpack($bomb); 1 }, 'without a context too' );
+
+    $dec->max_header_list_size(4035);
+    is( scalar( () = HTTP::Headers::Fast->from_hpack( "\xbe", $dec )->header('X-A') ), 1, 'right at the limit' );
+    ok( !eval { HTTP::Headers::Fast->from_hpack( "\xbe\xbe", $dec ); 1 }, 'one field over it' );
+
+    $dec->max_header_list_size(0);
+    is( scalar( () = HTTP::Headers::Fast->from_hpack( "\xbe" x 100, $dec )->header('X-A') ), 100, '0 for no limit' );
+}
+
+done_testing;
@@ -0,0 +1,74 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+can_ok( HTTP::Headers::Fast::, 'from_psgi_env' );
+
+my %env = (
+    REQUEST_METHOD       => 'POST',
+    PATH_INFO            => '/',
+    SERVER_NAME          => 'localhost',
+    HTTPS                => 'on',
+    HTTP_                => 'no name',
+    HTTP_HOST            => 'example.com',
+    HTTP_X_FORWARDED_FOR => '10.0.0.1, 10.0.0.2',
+    HTTP_COOKIE          => 'a=1; b=2',
+    HTTP_X_UNDEF         => undef,
+    CONTENT_TYPE         => 'text/plain',
+    CONTENT_LENGTH       => 12,
+    'psgi.version'       => [ 1, 1 ],
+);
+
+{
+    my $h = HTTP::Headers::Fast->from_psgi_env( \%env );
+    isa_ok( $h, 'HTTP::Headers::Fast' );
+    is_deeply(
+        {%$h},
+        {
+            host              => 'example.com',
+            'x-forwarded-for' => '10.0.0.1, 10.0.0.2',
+            cookie            => 'a=1; b=2',
+            'content-type'    => 'text/plain',
+            'content-length'  => 12,
+        },
+        'HTTP_* keys plus CONTENT_TYPE and CONTENT_LENGTH',
+    );
+    is( $HTTP::Headers::Fast::standard_case{'x-forwarded-for'}, 'X-Forwarded-For', 'names standardized' );
+    like( $h->as_string, qr/^X-Forwarded-For: 10\.0\.0\.1, 10\.0\.0\.2$/m, 'as_string' );
+    like( $h->as_string, qr/^Cookie: a=1; b=2$/m, 'names the built-in table has no spelling for too' );
+
+    $h->header( Host => 'other' );
+    is( $env{HTTP_HOST}, 'example.com', 'values are copies' );
+}
+
+{
+    local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 0;
+    my $h = HTTP::Headers::Fast->from_psgi_env( { HTTP_USER_AGENT => 'x' } );
+    is_deeply( {%$h}, { 'user-agent' => 'x' }, 'underscores become dashes regardless' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->from_psgi_env( { CONTENT_TYPE => 'a/b', HTTP_CONTENT_TYPE => 'c/d' } );
+    is_deeply( [ sort $h->header('Content-Type') ], [ 'a/b', 'c/d' ], 'both spellings are kept' );
+}
+
+{
+    package My::Headers;
+    our @ISA = ('HTTP::Headers::Fast');
+}
+isa_ok( My::Headers->from_psgi_env( {} ), 'My::Headers', 'subclass' );
+is_deeply( { %{ HTTP::Headers::Fast->from_psgi_env( {} ) } }, {}, 'empty env' );
+
+eval { HTTP::Headers::Fast->from_psgi_env('HTTP_HOST') };
+like( $@, qr/^Usage: HTTP::Headers::Fast->from_psgi_env\(\\%env\)/, 'croaks without a hash' );
+
+{
+    my $value = 'x' x 1024;
+    my $h = HTTP::Headers::Fast->from_psgi_env( { HTTP_X_BIG => $value } );
+    is( $h->header('X-Big'), $value, 'long values' );
+}
+
+done_testing;
@@ -0,0 +1,52 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+my $h = HTTP::Headers::Fast->new(
+    Foo            => [ 1, 2, 3 ],
+    Bar            => 'x',
+    'Content-Type' => 'text/plain',
+    'X-Empty'      => [],
+    'X-Obj'        => bless( [ 1, 2 ], 'Some::Class' ),
+);
+$h->{':authority'} = 'example.com';
+
+my @names = ( 'foo', 'Nope', 'BAR', 'content_type', ':authority', 'X-Empty', 'X-Obj', 'Bar' );
+my @expected = map { scalar $h->header($_) } @names;
+
+is_deeply( [ $h->get_many(@names) ], \@expected, 'as header() in scalar context, in order' );
+ok( !defined( ( $h->get_many('Nope') )[0] ), 'undef for a missing field' );
+is( scalar( () = $h->get_many( 'Nope', 'Nope' ) ), 2, 'one value per name' );
+is_deeply( [ $h->get_many ], [], 'no names' );
+
+is_deeply(
+    $h->get_many_hashref(@names),
+    { map { ( $names[$_] => $expected[$_] ) } 0 .. $#names },
+    'hashref variant keyed on the names as given',
+);
+ok( exists $h->get_many_hashref('Nope')->{Nope}, 'missing fields are there, undef' );
+is_deeply( $h->get_many_hashref, {}, 'no names, empty hash' );
+
+{
+    my @values = $h->get_many('Bar');
+    $values[0] .= '!';
+    is( $h->header('Bar'), 'x', 'values are copies' );
+}
+
+{
+    local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 0;
+    is_deeply( [ $h->get_many('content_type') ], [undef], 'honours $TRANSLATE_UNDERSCORE' );
+}
+
+{
+    my $lazy = HTTP::Headers::Fast->parse_lazy("Host: example.com\r\nAccept: */*\r\nAccept: text/html\r\n\r\n");
+    is_deeply( [ $lazy->get_many( 'Accept', 'Nope' ) ], [ '*/*, text/html', undef ], 'lazy objects' );
+    isa_ok( $lazy, 'HTTP::Headers::Fast::Lazy', 'which stay lazy' );
+    is_deeply( [ keys %$lazy ], ['accept'], 'only the fields asked for are fetched' );
+    is_deeply( $lazy->get_many_hashref('Host'), { Host => 'example.com' }, 'hashref variant on lazy objects' );
+}
+
+done_testing;
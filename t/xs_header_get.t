@@ -52,4 +52,14 @@ can_ok( HTTP::Headers::Fast::, '_header_get' );
     is_deeply( \@val, ['baaaaz'], 'escape field standardization' );
 }
 
+{
+    my $h = HTTP::Headers::Fast->new(foo_bar => "baz");
+    my @val = $h->_header_get('foo-bar', 1);
+
+    is_deeply( \@val, ['baz'], 'get already standardized field' );
+
+    @val = $h->_header_get('Foo_Bar', 1);
+    is_deeply( \@val, [], 'skip field standardization' );
+}
+
 done_testing;
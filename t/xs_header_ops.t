@@ -0,0 +1,67 @@
+use strict;
+use warnings;
+use Test::More;
+use B;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS ':ops';
+
+{
+    package My::Headers;
+    our @ISA = ('HTTP::Headers::Fast');
+
+    sub header {
+        my $self = shift;
+        return 'overridden';
+    }
+}
+
+my $h = HTTP::Headers::Fast->new( Foo => [qw( a b )], Bar => 1 );
+
+is( scalar $h->header('Foo'), 'a, b', 'scalar context' );
+is_deeply( [ $h->header('Foo') ], [qw( a b )], 'list context' );
+is( scalar $h->header('Nope'), undef, 'missing field in scalar context' );
+is_deeply( [ $h->header('Nope') ], [], 'missing field in list context' );
+is( scalar $h->_header_get('Foo'), 'b', '_header_get in scalar context' );
+
+$h->header( Baz => 2 );
+is( $h->header('Baz'), 2, 'set in void context' );
+
+is_deeply( [ $h->_header_set( Baz => 3 ) ], [2], '_header_set returns old' );
+$h->push_header( Baz => 4 );
+is_deeply( [ $h->header('Baz') ], [ 3, 4 ], 'push_header' );
+
+{
+    my $sub = bless HTTP::Headers::Fast->new( Foo => 1 ), 'My::Headers';
+    is( $sub->header('Foo'), 'overridden', 'subclass override' );
+    is( $sub->_header_get('Foo'), 1, 'subclass inherits' );
+}
+
+ok( !eval { $h->header; 1 }, 'croaks as usual' );
+like( $@, qr/^Usage/, 'with the usual message' );
+
+{
+    my $ops = 0;
+    my $code = sub { $h->header('Foo') };
+    my $op   = B::svref_2object($code)->START;
+    for ( ; $$op; $op = $op->next ) {
+        $ops++ if $op->name eq 'header_method';
+    }
+    SKIP: {
+        skip 'needs perl 5.22', 1 if $] < 5.022;
+        is( $ops, 1, 'method call compiled to a custom op' );
+    }
+}
+
+{
+    no HTTP::Headers::Fast::XS ':ops';
+    my $ops  = 0;
+    my $code = sub { $h->header('Foo') };
+    my $op   = B::svref_2object($code)->START;
+    for ( ; $$op; $op = $op->next ) {
+        $ops++ if $op->name eq 'header_method';
+    }
+    is( $ops, 0, 'not when turned off' );
+}
+
+done_testing;
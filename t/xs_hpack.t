@@ -0,0 +1,123 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+can_ok( HTTP::Headers::Fast::, 'to_hpack' );
+
+# one object per field, to pin down the order
+sub encode {
+    my ( $ctx, @fields ) = @_;
+    my $block = '';
+
+    while ( my ( $name, $value ) = splice @fields, 0, 2 ) {
+        my $h = HTTP::Headers::Fast->new;
+        $h->{$name} = $value;
+        $block .= $h->to_hpack($ctx);
+    }
+    unpack 'H*', $block;
+}
+
+# RFC 7541, C.6: responses, Huffman coded, 256 byte table
+{
+    my $ctx  = HTTP::Headers::Fast::XS::HPACK->new(256);
+    my @resp = (
+        'cache-control' => 'private',
+        date            => 'Mon, 21 Oct 2013 20:13:21 GMT',
+        location        => 'https://www.example.com',
+    );
+
+    is(
+        encode( $ctx, ':status' => 302, @resp ),
+        '488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff'
+          . '6e919d29ad171863c78f0b97c8e9ae82ae43d3',
+        'C.6.1',
+    );
+    is( $ctx->table_size, 222, 'C.6.1 table size' );
+
+    # the RFC Huffman codes "307" too, which doesn't make it any shorter
+    is( encode( $ctx, ':status' => 307, @resp ), '4803333037c1c0bf', 'C.6.2' );
+    is( $ctx->table_size, 222, 'C.6.2 table size' );
+
+    $resp[3] = 'Mon, 21 Oct 2013 20:13:22 GMT';
+    is(
+        encode(
+            $ctx,
+            ':status'          => 200,
+            @resp,
+            'content-encoding' => 'gzip',
+            'set-cookie'       => 'foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1',
+        ),
+        '88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7'
+          . 'f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b10'
+          . '63d5007',
+        'C.6.3',
+    );
+    is( $ctx->table_size, 215, 'C.6.3 table size' );
+}
+
+{
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new;
+    my $h   = HTTP::Headers::Fast->new(
+        'X-Request-Id' => 'abc',
+        ':method'      => 'GET',
+    );
+
+    my $first = unpack 'H*', $h->to_hpack($ctx);
+    like( $first, qr/^82/, 'pseudo-header field first, fully indexed' );
+    is( unpack( 'H*', $h->to_hpack($ctx) ), '82be', 'dynamic table reused' );
+    is( $ctx->max_table_size, 4096, 'default table size' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new(
+        Authorization       => 'secret',
+        Connection          => 'close',
+        'Transfer-Encoding' => 'chunked',
+    );
+    $h->{_private} = 1;
+
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new;
+    is( unpack( 'H*', $h->to_hpack($ctx) ), '1f08' . '8441496153', 'never indexed, the rest dropped' );
+    is( $ctx->table_size, 0, 'and not added' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( 'X-Thing' => [ 'a', "b\n c" ], ':Raw' => 'r' );
+    my $bytes = $h->to_hpack;
+
+    ok( index( $bytes, 'a' ) >= 0, 'short values go out raw' );
+    ok( index( $bytes, 'raw' ) >= 0, 'leading colon dropped' );
+    is(
+        unpack( 'H2', HTTP::Headers::Fast->new( 'X-A' => 1 )->to_hpack ),
+        '00',
+        'nothing indexed without a context',
+    );
+
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new;
+    $h->to_hpack($ctx);
+    is( $ctx->table_size, 3 * 32 + 7 + 1 + 7 + 3 + 3 + 1, 'every value indexed' );
+}
+
+{
+    my $ctx = HTTP::Headers::Fast::XS::HPACK->new;
+    my $h   = HTTP::Headers::Fast->new( ':status' => 200 );
+
+    $ctx->max_table_size(0);
+    $ctx->max_table_size(100);
+    is( unpack( 'H*', $h->to_hpack($ctx) ), '203f4588', 'size updates signalled once' );
+    is( unpack( 'H*', $h->to_hpack($ctx) ), '88', 'only once' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => "a\rb" );
+    ok( !eval { $h->to_hpack; 1 }, 'CR croaks' );
+    like( $@, qr/Value of field 'foo' has a CR or NUL/, 'with a message' );
+
+    ok( !eval { $h->to_hpack( bless {}, 'Nope' ); 1 }, 'bad context croaks' );
+    like( $@, qr/Not an HTTP::Headers::Fast::XS::HPACK object/, 'with a message' );
+}
+
+done_testing;
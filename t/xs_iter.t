@@ -0,0 +1,108 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+sub walk {
+    my $it = shift;
+    my @got;
+    while ( my ( $name, $value ) = $it->next ) {
+        push @got, [ $name, $value ];
+    }
+    return \@got;
+}
+
+sub scanned {
+    my @got;
+    shift->scan( sub { push @got, [@_] } );
+    return \@got;
+}
+
+{
+    my $h = HTTP::Headers::Fast->new(
+        Foo            => [ 1, 2, 3 ],
+        Bar            => 'x',
+        Date           => 'Tue, 11 Nov 2008 01:16:37 GMT',
+        'Content-Type' => 'text/plain',
+        'X-Obj'        => bless( [ 1, 2 ], 'Some::Class' ),
+        'X-Empty'      => [],
+    );
+    $h->{':authority'} = 'example.com';
+    $h->{_skipped}     = 'never';
+
+    my $it = $h->iter;
+    isa_ok( $it, 'HTTP::Headers::Fast::XS::Iterator' );
+    is_deeply( walk($it), scanned($h), 'same fields and order as scan' );
+    is_deeply( [ $it->next ], [], 'stays at the end' );
+
+    $it->reset;
+    is_deeply( walk($it), scanned($h), 'reset starts over' );
+
+    my $sort = sub { [ sort { "@$a" cmp "@$b" } @{ shift() } ] };
+    is_deeply( $sort->( walk( $h->iter(1) ) ), $sort->( scanned($h) ), 'same fields in hash order' );
+}
+
+{
+    my $h  = HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Date => 'Tue, 11 Nov 2008 01:16:37 GMT' );
+    my $it = $h->iter;
+    is( scalar $it->next, 'Date', 'scalar context gives the name' );
+    is_deeply( [ $it->next, $it->next ], [ map @$_, @{ scanned($h) }[ 1, 2 ] ], 'names stay put' );
+}
+
+{
+    my $it = HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x' )->iter;
+    is( scalar @{ walk($it) }, 3, 'keeps the object alive' );
+}
+
+for my $without_sort ( 0, 1 ) {
+    my $h = HTTP::Headers::Fast->new( map { ( "X-$_" => $_ ) } 1 .. 200 );
+    my $it = $h->iter($without_sort);
+    my %seen;
+    while ( my ( $name, $value ) = $it->next ) {
+        $seen{$name}++;
+        $h->remove_header($name) if $value % 2;
+    }
+    is( scalar keys %seen, 200, "deleting each field as it comes up ($without_sort)" );
+    is( scalar( grep { $_ > 1 } values %seen ), 0, "none twice ($without_sort)" );
+    is( scalar keys %$h, 100, "the others are left ($without_sort)" );
+}
+
+{
+    my $h  = HTTP::Headers::Fast->new( A => 1, C => 3 );
+    my $it = $h->iter;
+    my @names;
+    while ( my $name = $it->next ) {
+        push @names, $name;
+        $h->header( B => 2, D => 4 ) if $name eq 'A';
+    }
+    is_deeply( \@names, [qw(A B C D)], 'fields added after the current one come up' );
+}
+
+{
+    my $h  = HTTP::Headers::Fast->new( A => 1, B => 2, C => 3, D => 4 );
+    my $it = $h->iter;
+    my @names;
+    while ( my $name = $it->next ) {
+        push @names, $name;
+        $h->remove_header('C') if $name eq 'A';
+    }
+    is_deeply( \@names, [qw(A B D)], 'fields deleted before they come up are skipped' );
+
+    $h->header( C => 3 );
+    $it->reset;
+    is_deeply( [ map { scalar $it->next } 1 .. 4 ], [qw(A B C D)], 'reset sorts the names again' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->parse_lazy("Host: example.com\r\nAccept: */*\r\n\r\n");
+    is_deeply( walk( $h->iter ), [ [ Accept => '*/*' ], [ Host => 'example.com' ] ], 'lazy objects' );
+}
+
+is_deeply( walk( HTTP::Headers::Fast->new->iter ), [], 'no fields' );
+
+eval { HTTP::Headers::Fast::XS::Iterator::next( bless {}, 'Nope' ) };
+like( $@, qr/^Not an HTTP::Headers::Fast::XS::Iterator object/, 'croaks on other objects' );
+
+done_testing;
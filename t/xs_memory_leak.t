@@ -74,4 +74,28 @@ is( RefCounter->ref_count, 0, 'no leak' );
 }
 is( RefCounter->ref_count, 0, 'no leak' );
 
+{
+    my $obj = RefCounter->new;
+    my $h   = HTTP::Headers::Fast->new( foo => $obj );
+    undef $obj;
+    my $old = $h->header( foo => 'bar' );
+    isa_ok $old, 'RefCounter', 'replaced value still returned';
+}
+is( RefCounter->ref_count, 0, 'no leak' );
+
+{
+    my $h = HTTP::Headers::Fast->new( foo => RefCounter->new );
+    my @old = $h->header( foo => undef );
+    isa_ok $old[0], 'RefCounter', 'deleted value still returned';
+    ok( !defined $h->header('foo'), 'and deleted' );
+}
+is( RefCounter->ref_count, 0, 'no leak' );
+
+{
+    my $h = HTTP::Headers::Fast->new( 'Content-Type' => RefCounter->new );
+    $h->header( 'Content-Type' => 'text/plain' ) for 1 .. 3;
+    is( $h->header('content_type'), 'text/plain', 'well-known key replaced' );
+}
+is( RefCounter->ref_count, 0, 'no leak' );
+
 done_testing;
@@ -0,0 +1,107 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+can_ok( HTTP::Headers::Fast::, 'parse' );
+
+sub parsed { +{ %{ HTTP::Headers::Fast->parse(shift) } } }
+
+{
+    my $h = HTTP::Headers::Fast->parse(
+        "Content-Type: text/html\r\n"
+      . "Set-Cookie: a=1\r\n"
+      . "X-Custom-Thing:no-space\r\n"
+      . "Set-Cookie: b=2\r\n"
+      . "Empty:\r\n"
+      . "Padded  :  \t value \t \r\n"
+      . "\r\n"
+      . "the body\r\n"
+    );
+    isa_ok( $h, 'HTTP::Headers::Fast' );
+    is_deeply(
+        {%$h},
+        {
+            'content-type'   => 'text/html',
+            'set-cookie'     => [ 'a=1', 'b=2' ],
+            'x-custom-thing' => 'no-space',
+            empty            => '',
+            padded           => 'value',
+        },
+        'fields stored as new() stores them, up to the empty line',
+    );
+    is( $h->header('X-Custom-Thing'), 'no-space', 'usable as any other object' );
+    is( $HTTP::Headers::Fast::standard_case{'x-custom-thing'}, 'X-Custom-Thing', 'names standardized' );
+}
+
+is_deeply(
+    parsed("Foo: 1\nBar: 2\n\n"),
+    { foo => 1, bar => 2 },
+    'bare LF line ends',
+);
+is_deeply(
+    parsed("Foo: 1\r\nBar: 2"),
+    { foo => 1, bar => 2 },
+    'the end of the string ends the block too',
+);
+is_deeply( parsed(''), {}, 'empty block' );
+is_deeply( parsed("\r\nFoo: 1\r\n"), {}, 'just the empty line' );
+is_deeply( parsed("X_Under: 1\r\n"), { 'x-under' => 1 }, 'underscores translated' );
+
+{
+    my $block = "Foo: first\r\n  second \r\n\tthird\r\nBar: 1\r\n\r\n";
+    my $h     = HTTP::Headers::Fast->parse($block);
+
+    is( $h->{foo}, "first\n  second\n\tthird", 'continuation lines kept after a newline' );
+    is( $h->as_string, "Bar: 1\nFoo: first\n  second\n\tthird\n", 'and printed back folded' );
+}
+
+{
+    # as many long values as it takes to reach every vector and tail case
+    my ( $block, %expect );
+    for my $len ( 0 .. 70 ) {
+        my $name  = 'X-' . ( 'n' x $len );
+        my $value = join '', map { chr( 33 + ( $_ * 7 ) % 94 ) } 1 .. $len;
+        $value =~ s/://g;
+        $block .= "$name: $value\x{80}\xff\r\n";
+        $expect{ lc $name } = "$value\x{80}\xff";
+    }
+    is_deeply( parsed($block), \%expect, 'names and values of all lengths' );
+
+    for my $at ( 0, 1, 15, 16, 17, 31, 32, 33, 47, 64 ) {
+        my $value = 'v' x 70;
+        substr( $value, $at, 1 ) = "\x01";
+        ok( !eval { parsed("Foo: $value\r\n") }, "control character at $at croaks" );
+        like( $@, qr/^Malformed header block: control character in line 'Foo: v*/, 'with a message' );
+    }
+}
+
+{
+    package My::Headers;
+    our @ISA = 'HTTP::Headers::Fast';
+}
+isa_ok( My::Headers->parse("Foo: 1\r\n"), 'My::Headers', 'subclass' );
+
+{
+    my @bad = (
+        "Foo\r\n"           => qr/no ':' in line 'Foo'/,
+        "Foo"               => qr/no ':' in line 'Foo'/,
+        "Foo bar: 1\r\n"    => qr/no ':' in line 'Foo bar: 1'/,
+        ": 1\r\n"           => qr/no field name in line ': 1'/,
+        " Foo: 1\r\n"       => qr/continuation without a field in line ' Foo: 1'/,
+        "Foo: 1\rBar: 2\r\n" => qr/CR without LF in line 'Foo: 1'/,
+        "Foo: 1\x7f\r\n"    => qr/control character in line 'Foo: 1\x7f'/,
+        "Foo: 1\0\r\n"      => qr/control character in line 'Foo: 1\0'/,
+        "F\x01o: 1\r\n"     => qr/no ':' in line 'F\x01o: 1'/,
+    );
+
+    while ( my ( $block, $error ) = splice @bad, 0, 2 ) {
+        ( my $name = $block ) =~ s/([^\x20-\x7e])/sprintf '\\x%02x', ord $1/ge;
+        ok( !eval { parsed($block); 1 }, "$name croaks" );
+        like( $@, qr/^Malformed header block: $error/, 'with a message' );
+    }
+}
+
+done_testing;
@@ -0,0 +1,88 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+sub corpus { HTTP::Headers::Fast::XS::parse_corpus(@_) }
+sub hashes { [ map +{%$_}, @{ shift() } ] }
+
+# what parse() makes of each block, split as parse_corpus() splits them
+sub expected {
+    my ( $corpus, @fields ) = @_;
+    my @blocks = $corpus =~ /\G((?:[^\n]*[^\r\n][^\n]*(?:\n|\z))*(?:\r?\n|\z))/gc;
+    pop @blocks if @blocks && $blocks[-1] eq '';
+    my %want = map +( HTTP::Headers::Fast::_standardize_field_name($_) => 1 ), @fields;
+
+    return [
+        map {
+            my $h = HTTP::Headers::Fast->parse($_);
+            @fields ? +{ map +( $_ => $h->{$_} ), grep $want{$_}, keys %$h } : +{%$h};
+        } @blocks
+    ];
+}
+
+my @blocks = (
+    "Host: a.example\r\nUser-Agent: one\r\n\r\n",
+    "host: b.example\nX-Folded: a\n  b\n\tc\nSet-Cookie: x=1\nSet-Cookie: y=2\n\n",
+    "\r\n",
+    "\n",
+    "User_Agent: three\r\nContent-Type: text/plain\r\n\r\n",
+);
+my $corpus = join '', map { $blocks[ $_ % @blocks ] } 0 .. 499;
+
+for my $threads ( 1 .. 5, 17 ) {
+    my $objects = corpus( $corpus, threads => $threads );
+    is( scalar @$objects, 500, "$threads threads: one object per block" );
+    is_deeply( hashes($objects), expected($corpus), "$threads threads: as parse() parses each block" );
+    is_deeply(
+        hashes( corpus( $corpus, threads => $threads, fields => [ 'HOST', 'x_folded' ] ) ),
+        expected( $corpus, 'Host', 'X-Folded' ),
+        "$threads threads: only the fields asked for",
+    );
+}
+
+{
+    my $objects = corpus($corpus);
+    isa_ok( $objects->[0], 'HTTP::Headers::Fast' );
+    is_deeply( hashes($objects), expected($corpus), 'default number of threads' );
+    is( $objects->[1]->header('X-Folded'), "a\n  b\n\tc", 'folded values' );
+}
+
+is_deeply( corpus(''), [], 'empty corpus' );
+is_deeply( hashes( corpus( "A: 1\r\n\r\nB: 2", threads => 2 ) ), [ { a => 1 }, { b => 2 } ],
+    'the last block may end with the corpus' );
+is_deeply( hashes( corpus( "\n\nA: 1\n", threads => 3 ) ), [ {}, {}, { a => 1 } ], 'empty blocks' );
+
+{
+    my $bad = $corpus . "Foo: 1\r\nno colon\r\n\r\n" . $corpus;
+    for my $threads ( 1, 4 ) {
+        eval { corpus( $bad, threads => $threads ) };
+        like( $@, qr/^Malformed header block: no ':' in line 'no colon'/, "$threads threads: croaks on a malformed block" );
+    }
+    eval { corpus( $bad, threads => 4, fields => ['Host'] ) };
+    like( $@, qr/^Malformed header block: /, 'fields not asked for are still checked' );
+}
+
+eval { corpus( $corpus, threads => 0 ) };
+like( $@, qr/^parse_corpus threads must be 1 to \d+/, 'threads out of range' );
+
+eval { corpus( $corpus, fields => 'Host' ) };
+like( $@, qr/^parse_corpus fields must be an array reference/, 'fields not an array' );
+
+eval { corpus( $corpus, nope => 1 ) };
+like( $@, qr/^Unknown parse_corpus option 'nope'/, 'unknown option' );
+
+eval { corpus( $corpus, 'threads' ) };
+like( $@, qr/^Usage: HTTP::Headers::Fast::XS::parse_corpus\(\$corpus, %options\)/, 'odd options' );
+
+{
+    my $attack = join '', map "X-Attack-$_: 1\r\nX-Wanted-Corpus: 2\r\n\r\n", 1 .. 50;
+    my $objects = corpus( $attack, threads => 2, fields => [ 'X-Wanted-Corpus', 'X-Never-Sent-Corpus' ] );
+    is_deeply( hashes($objects)->[0], { 'x-wanted-corpus' => 2 }, 'fields: only the wanted field' );
+    ok( !( grep /^x-(attack|never-sent-corpus)/, keys %HTTP::Headers::Fast::standard_case ),
+        'names skipped or only asked for are not added to %standard_case' );
+}
+
+done_testing;
@@ -0,0 +1,160 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+use Storable ();
+
+can_ok( HTTP::Headers::Fast::, 'parse_lazy' );
+
+my $block = "Host: example.com\r\n"
+          . "Set-Cookie: a=1\r\n"
+          . "X-Folded: one \r\n"
+          . "  two\r\n"
+          . "Content_Type: text/html\r\n"
+          . "set-cookie: b=2\r\n"
+          . "\r\n"
+          . "the body";
+
+sub lazy { HTTP::Headers::Fast->parse_lazy( @_ ? shift : $block ) }
+
+{
+    my $h = lazy();
+    isa_ok( $h, 'HTTP::Headers::Fast::Lazy' );
+    isa_ok( $h, 'HTTP::Headers::Fast' );
+    isa_ok( $h, 'HTTP::Headers' );
+    is( scalar keys %$h, 0, 'nothing stored up front' );
+
+    is( $h->header('Host'), 'example.com', 'header() fetches a field' );
+    is_deeply( [ keys %$h ], ['host'], 'and only that field' );
+
+    is_deeply( [ $h->header('SET-COOKIE') ], [ 'a=1', 'b=2' ], 'repeated fields in order' );
+    is( $h->header('x-folded'), "one\n  two", 'folded lines as parse() unfolds them' );
+    is( $h->header('Content-Type'), 'text/html', 'names standardized as new() would' );
+    is( $h->header('Nope'), undef, 'missing field' );
+    is( ref $h, 'HTTP::Headers::Fast::Lazy', 'still lazy after reads' );
+}
+
+{
+    my $h = lazy();
+    my $parsed = HTTP::Headers::Fast->parse($block);
+    is( $h->as_string, $parsed->as_string, 'as_string sees every field' );
+    is( ref $h, 'HTTP::Headers::Fast', 'and makes it an ordinary object' );
+    is_deeply( {%$h}, {%$parsed}, 'same hash as parse()' );
+}
+
+{
+    my $h = lazy();
+    is_deeply( [ $h->_header_get('set-cookie', 1) ], [ 'a=1', 'b=2' ], '_header_get' );
+
+    is_deeply( [ $h->header( Host => 'other' ) ], ['example.com'], 'set returns the raw value' );
+    is( $h->header('Host'), 'other', 'and replaces it' );
+
+    $h->push_header( 'X-Folded' => 'three' );
+    is_deeply( [ $h->header('X-Folded') ], [ "one\n  two", 'three' ], 'push_header appends to it' );
+
+    $h->header( 'Content-Type' => undef );
+    is( $h->header('Content-Type'), undef, 'deleted fields stay deleted' );
+
+    is_deeply(
+        [ sort $h->header_field_names ],
+        [ sort qw(Host X-Folded SET-COOKIE) ],    # as first spelled above
+        'the rest is fetched once for header_field_names',
+    );
+}
+
+{
+    my $h = lazy();
+    $h->header('Host');
+    my $clone = $h->clone;
+    is( ref $clone, 'HTTP::Headers::Fast', 'clone gives an ordinary object' );
+    is_deeply( {%$clone}, { %{ HTTP::Headers::Fast->parse($block) } }, 'with every field' );
+
+    my $thawed = Storable::thaw( Storable::freeze( lazy() ) );
+    is( ref $thawed, 'HTTP::Headers::Fast', 'Storable round trip gives an ordinary object' );
+    is( $thawed->header('X-Folded'), "one\n  two", 'with the fields' );
+    is_deeply( [ sort $thawed->header_field_names ], [ sort $clone->header_field_names ], 'keeps every field' );
+}
+
+{
+    my $bytes = "Foo: 1\r\n\r\n";
+    my $h = lazy($bytes);
+    substr( $bytes, 5, 1, '2' );
+    is( $h->header('Foo'), 1, 'a copy of the block, not the caller\'s buffer' );
+}
+
+for my $bad ( "no colon here\r\n", " cont\r\n", "Foo: a\rb\r\n" ) {
+    ( my $name = $bad ) =~ s/([\r\n])/sprintf '\\x%02x', ord $1/ge;
+    eval { lazy($bad) };
+    like( $@, qr/^Malformed header block: /, "croaks on $name" );
+}
+
+is( lazy('')->as_string, '', 'empty block' );
+
+{
+    package My::Headers;
+    our @ISA = ('HTTP::Headers::Fast');
+    sub mine { scalar keys %{ $_[0] } }
+
+    package My::Header;
+    our @ISA = ('HTTP::Headers::Fast');
+    sub header { my $self = shift; return scalar( keys %$self ) . ':' . $self->SUPER::header(@_) }
+}
+
+{
+    my $h = My::Headers->parse_lazy($block);
+    isa_ok( $h, 'HTTP::Headers::Fast::Lazy' );
+    isa_ok( $h, 'My::Headers', 'a subclass' );
+    is( $h->header('Host'), 'example.com', 'fetches as usual' );
+
+    $h->as_string;
+    is( ref $h, 'My::Headers', 'and becomes one once materialized' );
+    is( $h->mine, 4, 'with its own methods' );
+
+    for my $copy ( Storable::dclone( My::Headers->parse_lazy($block) ),
+        Storable::thaw( Storable::freeze( My::Headers->parse_lazy($block) ) ) ) {
+        is( ref $copy, 'My::Headers', 'Storable copies keep it' );
+        is( $copy->mine, 4, 'with its methods' );
+        is( $copy->header('Host'), 'example.com', 'and fields' );
+    }
+
+    my $again = My::Headers->parse_lazy($block);
+    is( ref $again->clone, 'My::Headers', 'clone keeps it too' );
+    ok( !$again->isa('Some::Other'), 'isa nothing else' );
+
+    my $from_object = $h->parse_lazy($block);
+    HTTP::Headers::Fast::XS::_lazy_materialize($from_object);
+    is( ref $from_object, 'My::Headers', 'called on an object' );
+
+    my $from_lazy = lazy()->parse_lazy($block);
+    HTTP::Headers::Fast::XS::_lazy_materialize($from_lazy);
+    is( ref $from_lazy, 'HTTP::Headers::Fast', 'called on a lazy object' );
+}
+
+{
+    my $h = My::Headers->parse_lazy($block);
+    ok( $h->can('mine'), 'can finds the class\'s own methods while lazy' );
+    is( $h->mine, 4, 'which see every field' );
+    is( ref $h, 'My::Headers', 'as the object is materialized first' );
+
+    $h = My::Headers->parse_lazy($block);
+    my $mine = $h->can('mine');
+    is( $h->$mine, 4, 'so does what can returns' );
+
+    $h = My::Headers->parse_lazy($block);
+    $h->header('Host');
+    is_deeply( [ keys %$h ], ['host'], 'while our own header still fetches one field' );
+    eval { $h->nope };
+    like( $@, qr/^Can't locate object method "nope" via package "My::Headers"/, 'missing methods croak' );
+    isa_ok( $h, 'HTTP::Headers::Fast::Lazy', 'without materializing it' );
+
+    $h = My::Header->parse_lazy($block);
+    is( $h->header('Host'), '4:example.com', 'a subclass overriding header sees every field' );
+
+    no warnings 'once';
+    local *HTTP::Headers::Fast::added_later = sub { scalar keys %{ $_[0] } };
+    is( lazy()->added_later, 4, 'methods added after loading see every field' );
+}
+
+done_testing;
@@ -0,0 +1,72 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+my @blocks = (
+    "Host: a.example\r\nUser-Agent: one\r\nX-Folded: a\r\n  b\r\n\r\nbody",
+    "host: b.example\nSet-Cookie: x=1\nSet-Cookie: y=2\n",
+    "",
+    "User_Agent: three\r\n\r\n",
+);
+
+{
+    my $objects = HTTP::Headers::Fast::XS::parse_many( \@blocks );
+    is( ref $objects, 'ARRAY', 'an array reference' );
+    is( scalar @$objects, scalar @blocks, 'one object per block' );
+    isa_ok( $_, 'HTTP::Headers::Fast' ) for @$objects;
+    is_deeply(
+        [ map +{%$_}, @$objects ],
+        [ map +{ %{ HTTP::Headers::Fast->parse($_) } }, @blocks ],
+        'same objects as parse() makes, in order',
+    );
+}
+
+{
+    my $objects = HTTP::Headers::Fast::XS::parse_many( \@blocks, [ 'HOST', 'user_agent', 'X-Folded' ] );
+    is_deeply(
+        [ map +{%$_}, @$objects ],
+        [
+            { host => 'a.example', 'user-agent' => 'one', 'x-folded' => "a\n  b" },
+            { host => 'b.example' },
+            {},
+            { 'user-agent' => 'three' },
+        ],
+        'only the fields asked for',
+    );
+}
+
+is_deeply( HTTP::Headers::Fast::XS::parse_many( [] ), [], 'no blocks' );
+is_deeply(
+    [ map +{%$_}, @{ HTTP::Headers::Fast::XS::parse_many( \@blocks, undef ) } ],
+    [ map +{ %{ HTTP::Headers::Fast->parse($_) } }, @blocks ],
+    'undef fields means all of them',
+);
+
+eval { HTTP::Headers::Fast::XS::parse_many( [ "Foo: 1\r\n", "bad\r\n" ], ['Foo'] ) };
+like( $@, qr/^Malformed header block: no ':'/, 'croaks on a malformed block, even with fields' );
+
+eval { HTTP::Headers::Fast::XS::parse_many("Foo: 1\r\n") };
+like( $@, qr/^Usage: HTTP::Headers::Fast::XS::parse_many\(\\\@blocks\[, \\\@fields\]\)/, 'croaks without an array' );
+
+eval { HTTP::Headers::Fast::XS::parse_many( [], 'Foo' ) };
+like( $@, qr/^Usage: /, 'croaks when fields is not an array' );
+
+{
+    my @many = ( "A: 1\r\nB: 2\r\n  3\r\nB: 4\r\n" ) x 10_000;
+    my $objects = HTTP::Headers::Fast::XS::parse_many( \@many );
+    is_deeply( { %{ $objects->[-1] } }, { a => 1, b => [ "2\n  3", 4 ] }, 'large batch' );
+}
+
+{
+    my @attack = map "X-Attack-$_: 1\r\nX-Wanted-Many: 2\r\n", 1 .. 50;
+    my $objects = HTTP::Headers::Fast::XS::parse_many( \@attack, [ 'X-Wanted-Many', 'X-Never-Sent-Many' ] );
+    is_deeply( { %{ $objects->[0] } }, { 'x-wanted-many' => 2 }, 'only the wanted field' );
+    is( $objects->[0]->as_string, "X-Wanted-Many: 2\n", 'kept fields keep their case' );
+    ok( !( grep /^x-(attack|never-sent-many)/, keys %HTTP::Headers::Fast::standard_case ),
+        'names skipped or only asked for are not added to %standard_case' );
+}
+
+done_testing;
@@ -0,0 +1,109 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+my $block = "Host: example.com\r\n"
+          . "Cookie: " . ( 'c' x 3000 ) . "\r\n"
+          . "X-Folded: one\r\n two\r\n"
+          . "Accept: */*\r\n"
+          . "Accept: text/html\r\n"
+          . "\r\n";
+my $body   = "body bytes";
+my %expect = %{ HTTP::Headers::Fast->parse($block) };
+
+for my $size ( 1, 2, 3, 7, 64, length $block ) {
+    my $parser = HTTP::Headers::Fast::XS::Parser->new;
+    my @chunks = unpack "(a$size)*", $block . $body;
+    my ( $h, $fed );
+
+    while ( defined( my $chunk = shift @chunks ) ) {
+        $fed++;
+        last if $h = $parser->feed($chunk);
+    }
+    isa_ok( $h, 'HTTP::Headers::Fast', "$size byte chunks" );
+    is_deeply( {%$h}, \%expect, 'same as parse()' );
+    is( $parser->leftover . join( '', @chunks ), $body, 'leftover' );
+    is( $parser->consumed, length $block, 'consumed' );
+    is( $parser->fields, 5, 'fields' );
+
+    ok( !eval { $parser->feed('more'); 1 }, 'feed() after the end croaks' );
+    like( $@, qr/already has a complete header block/, 'with a message' );
+
+    $parser->reset;
+    is( $parser->feed("Foo: 1\n\n")->header('Foo'), 1, 'reset' );
+}
+
+{
+    my $parser = HTTP::Headers::Fast::XS::Parser->new;
+    ok( !defined $parser->feed("Foo: 1\r\n"), 'not done' );
+    is( $parser->fields, 0, 'a field is only parsed once the next line starts' );
+    ok( !defined $parser->feed("B"), 'not done' );
+    is( $parser->fields, 1, 'now it is' );
+    is( $parser->leftover, '', 'no leftover yet' );
+}
+
+{
+    my $parser = HTTP::Headers::Fast::XS::Parser->new( max_size => 20 );
+    ok( !defined $parser->feed( 'X-Long: ' . 'x' x 12 ), 'under the limit' );
+    ok( !eval { $parser->feed('x'); 1 }, 'over the size limit' );
+    like( $@, qr/^Header block over the 20 byte limit/, 'with a message' );
+
+    ok( !eval { $parser->feed("\r\n\r\n"); 1 }, 'unusable after that' );
+    like( $@, qr/can't go on after an error; reset\(\) it/, 'with a message' );
+
+    $parser->reset;
+    isa_ok( $parser->feed("Foo: 1\r\n\r\n" . 'x' x 100), 'HTTP::Headers::Fast', 'body not counted' );
+}
+
+{
+    my $flood  = join( '', map "X-$_: 1\r\n", 1 .. 1000 ) . "\r\n";
+    my $parser = HTTP::Headers::Fast::XS::Parser->new( max_size => 100, max_fields => 0 );
+    ok( !eval { $parser->feed($flood); 1 }, 'one chunk over the size limit' );
+    like( $@, qr/^Header block over the 100 byte limit/, 'with a message' );
+    cmp_ok( $parser->fields, '<=', 100 / length("X-1: 1\r\n"), 'nothing past the limit was parsed' );
+
+    $parser = HTTP::Headers::Fast::XS::Parser->new;
+    ok( !eval { $parser->feed( join( '', map "X-$_: " . ( 'x' x 1000 ) . "\r\n", 1 .. 200 ) ); 1 },
+        'the size limit is reached before the field limit' );
+    like( $@, qr/^Header block over the 65536 byte limit/, 'with a message' );
+
+    my $exact = "Foo: 1\r\nBar: 2\r\n\r\n";
+    $parser = HTTP::Headers::Fast::XS::Parser->new( max_size => length $exact );
+    isa_ok( $parser->feed( $exact . 'body' ), 'HTTP::Headers::Fast', 'a block of exactly the limit' );
+    is( $parser->leftover, 'body', 'leftover' );
+}
+
+{
+    my $parser = HTTP::Headers::Fast::XS::Parser->new( max_fields => 2, max_size => 0 );
+    ok( !eval { $parser->feed("A: 1\r\nB: 2\r\nC: 3\r\n\r\n"); 1 }, 'over the field limit' );
+    like( $@, qr/^Header block over the 2 field limit/, 'with a message' );
+
+    $parser = HTTP::Headers::Fast::XS::Parser->new( max_fields => 0, max_size => 0 );
+    my $h = $parser->feed( join( '', map "X-$_: 1\r\n", 1 .. 1000 ) . "\r\n" );
+    is( scalar keys %$h, 1000, 'no limits' );
+}
+
+{
+    my $parser = HTTP::Headers::Fast::XS::Parser->new;
+    ok( !eval { $parser->feed("Foo\r\n\r\n"); 1 }, 'malformed' );
+    like( $@, qr/^Malformed header block: no ':' in line 'Foo'/, 'croaks as parse() does' );
+}
+
+{
+    package My::Headers;
+    our @ISA = 'HTTP::Headers::Fast';
+}
+
+isa_ok(
+    HTTP::Headers::Fast::XS::Parser->new( class => 'My::Headers' )->feed("\r\n"),
+    'My::Headers',
+    'class option',
+);
+
+ok( !eval { HTTP::Headers::Fast::XS::Parser->new( nope => 1 ); 1 }, 'unknown option' );
+like( $@, qr/Unknown HTTP::Headers::Fast::XS::Parser option 'nope'/, 'croaks' );
+
+done_testing;
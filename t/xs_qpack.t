@@ -0,0 +1,103 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+use HTTP::Headers::Fast::XS;
+
+can_ok( HTTP::Headers::Fast::, qw( to_qpack from_qpack ) );
+
+sub decode { HTTP::Headers::Fast->from_qpack( pack 'H*', shift ) }
+
+sub encode {
+    my $h = HTTP::Headers::Fast->new;
+    $h->{ $_[0] } = $_[1];
+    unpack 'H*', $h->to_qpack;
+}
+
+# RFC 9204, B.1
+is_deeply(
+    { %{ decode('0000510b2f696e6465782e68746d6c') } },
+    { ':path' => '/index.html' },
+    'literal with name reference',
+);
+
+is( encode( ':path' => '/' ),                  '0000c1',         'indexed' );
+is( encode( 'x-frame-options' => 'sameorigin' ), '0000ff23', 'indexed, long index' );
+like( encode( 'content-length' => 1234 ), qr/^000054/, 'literal with name reference' );
+like( encode( 'x-custom' => 'yes' ),       qr/^00002e/, 'literal with literal name' );
+like( encode( authorization => 'secret' ), qr/^00007f45/, 'authorization never indexed' );
+
+{
+    my %static = (
+        ':status'                   => [qw( 100 103 200 204 206 302 304 400 403 404 421 425 500 503 )],
+        ':method'                   => [qw( CONNECT DELETE GET HEAD OPTIONS POST PUT )],
+        'cache-control'             => [ 'max-age=0', 'no-cache', 'public, max-age=31536000' ],
+        'content-type'              => [ 'application/json', 'text/html; charset=utf-8' ],
+        'strict-transport-security' => ['max-age=31536000; includesubdomains; preload'],
+        'access-control-allow-credentials' => [qw( FALSE TRUE )],
+        'x-frame-options'           => [qw( deny sameorigin )],
+        age                         => [0],
+        vary                        => ['origin'],
+    );
+
+    for my $name ( sort keys %static ) {
+        for my $value ( @{ $static{$name} } ) {
+            my $hex = encode( $name => $value );
+            like( $hex, qr/^0000(?:c|d|e|f)./, "$name: $value is indexed" );
+            is_deeply( { %{ decode($hex) } }, { $name => $value }, 'and decodes back' );
+        }
+    }
+}
+
+{
+    my $h = HTTP::Headers::Fast->new(
+        ':status'      => 200,
+        'Content-Type' => 'text/html; charset=utf-8',
+        'Set-Cookie'   => [qw( a=1 b=2 c=3 )],
+        'X-Long'       => 'x' x 5000,
+        'X-Custom'     => 'custom value',
+        Authorization  => 'Basic Zm9vOmJhcg==',
+        Server         => 'perl',
+        'X-Binary'     => join( '', map chr, 1 .. 9, 11, 12, 14 .. 255 ),
+        Connection     => 'close',
+    );
+
+    my $block = $h->to_qpack;
+    delete $h->{connection};
+    is_deeply( { %{ HTTP::Headers::Fast->from_qpack($block) } }, {%$h}, 'round trip' );
+    is( substr( unpack( 'H*', $block ), 0, 6 ), '0000d9', 'pseudo-header field first' );
+}
+
+{
+    my @bad = (
+        '01'         => qr/dynamic table references are not supported/,
+        '000080'     => qr/dynamic table references are not supported/,
+        '000040'     => qr/dynamic table references are not supported/,
+        '000010'     => qr/dynamic table references are not supported/,
+        '000000'     => qr/dynamic table references are not supported/,
+        '0000ff'     => qr/truncated or oversized integer/,
+        '0000ff24'   => qr/no entry 99 in the static table/,
+        '000051'     => qr/truncated string/,
+        '00002f'     => qr/truncated string/,
+        '0000518125' => qr/bad Huffman code/,
+    );
+
+    while ( my ( $hex, $error ) = splice @bad, 0, 2 ) {
+        ok( !eval { decode($hex); 1 }, "$hex croaks" );
+        like( $@, qr/^Malformed QPACK field section: $error/, 'with a message' );
+    }
+}
+
+{
+    my $block = HTTP::Headers::Fast->new( 'X-Long' => [ ( 'x' x 1000 ) x 70 ] )->to_qpack;
+
+    ok( !eval { HTTP::Headers::Fast->from_qpack($block); 1 }, 'a field section over 65536 bytes croaks' );
+    like( $@, qr/^QPACK field section over the 65536 byte limit/, 'with a message' );
+    ok( !eval { HTTP::Headers::Fast->from_qpack( $block, 69 * 1038 ); 1 }, 'one field over a given limit' );
+    is( scalar( () = HTTP::Headers::Fast->from_qpack( $block, 70 * 1038 )->header('X-Long') ), 70,
+        'right at it' );
+    is( scalar( () = HTTP::Headers::Fast->from_qpack( $block, 0 )->header('X-Long') ), 70, '0 for no limit' );
+}
+
+done_testing;
@@ -0,0 +1,145 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+
+my ( $perl_remove_header, $perl_remove_content_headers );
+BEGIN {
+    $perl_remove_header          = \&HTTP::Headers::Fast::remove_header;
+    $perl_remove_content_headers = \&HTTP::Headers::Fast::remove_content_headers;
+}
+
+use HTTP::Headers::Fast::XS;
+
+isnt( \&HTTP::Headers::Fast::remove_header, $perl_remove_header, 'remove_header is replaced' );
+isnt( \&HTTP::Headers::Fast::remove_content_headers, $perl_remove_content_headers,
+    'remove_content_headers is replaced' );
+
+my @headers = (
+    Foo                   => [ 1, 2, 3 ],
+    Bar                   => 'x',
+    Date                  => 'Tue, 11 Nov 2008 01:16:37 GMT',
+    Allow                 => 'GET',
+    Expires               => 0,
+    'Last-Modified'       => 'Mon, 10 Nov 2008 01:16:37 GMT',
+    'Content-Type'        => 'text/plain',
+    'Content-Length'      => 12,
+    'Content-Disposition' => 'inline',
+    'Content-X-Custom'    => [ 'a', 'b' ],
+    'X-Content-Type'      => 'not an entity header',
+    'X-Obj'               => bless( [ 1, 2 ], 'Some::Class' ),
+    'X-Empty'             => [],
+);
+
+my @fields = ( 'foo', 'Nope', 'BAR', 'content_type', 'X-Obj', 'X-Empty', 'Foo' );
+
+{
+    my ( $xs, $perl ) = ( HTTP::Headers::Fast->new(@headers), HTTP::Headers::Fast->new(@headers) );
+    is_deeply( [ $xs->remove_header(@fields) ], [ $perl_remove_header->( $perl, @fields ) ],
+        'remove_header returns what the perl version does' );
+    is_deeply( {%$xs}, {%$perl}, 'and leaves the same fields' );
+}
+
+{
+    my ( $xs, $perl ) = ( HTTP::Headers::Fast->new(@headers), HTTP::Headers::Fast->new(@headers) );
+    is( scalar $xs->remove_header(@fields), scalar $perl_remove_header->( $perl, @fields ),
+        'scalar context gives the number of values' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new(@headers);
+    $h->remove_header(@fields);
+    is_deeply( {%$h}, do { my $p = HTTP::Headers::Fast->new(@headers); $perl_remove_header->( $p, @fields ); +{%$p} }, 'void context' );
+    is_deeply( [ $h->remove_header ], [], 'no fields' );
+}
+
+{
+    my $obj = bless [ 1, 2 ], 'Some::Class';
+    my $h   = HTTP::Headers::Fast->new( 'X-Obj' => $obj );
+    my ($removed) = $h->remove_header('X-Obj');
+    is( $removed, $obj, 'objects come back as they are' );
+}
+
+{
+    local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 0;
+    my $h = HTTP::Headers::Fast->new( 'Content-Type' => 'text/plain' );
+    is_deeply( [ $h->remove_header('content_type') ], [], 'honours $TRANSLATE_UNDERSCORE' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new;
+    $h->{':authority'} = 'example.com';
+    $h->{':x_y'}       = 'kept as is';
+    is_deeply( [ $h->remove_header( ':Authority', ':x-y' ) ], ['example.com'],
+        "':' names are lowercased, but not translated" );
+    is_deeply( [ $h->remove_header(':X_Y') ], ['kept as is'], 'so they match what was stored' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => 1 );
+    $h->remove_header( 'X-Never-Seen', 'x_never_seen_either' );
+    ok( !exists $HTTP::Headers::Fast::standard_case{$_}, "removing $_ leaves %standard_case alone" )
+        for 'x-never-seen', 'x-never-seen-either';
+}
+
+{
+    my ( $xs, $perl ) = ( HTTP::Headers::Fast->new(@headers), HTTP::Headers::Fast->new(@headers) );
+    $_->{_private} = 'kept' for $xs, $perl;
+    my $c = $xs->remove_content_headers;
+    my $p = $perl_remove_content_headers->($perl);
+    isa_ok( $c, 'HTTP::Headers::Fast' );
+    is_deeply( {%$c}, {%$p}, 'remove_content_headers returns what the perl version does' );
+    is_deeply( {%$xs}, {%$perl}, 'and leaves the same fields' );
+    is( $c->header('Content-Type'), 'text/plain', 'the returned object works' );
+}
+
+{
+    my $h      = HTTP::Headers::Fast->new( 'Content-X-Custom' => [ 'a', 'b' ] );
+    my $values = $h->{'content-x-custom'};
+    my $c      = $h->remove_content_headers;
+    is( $c->{'content-x-custom'}, $values, 'values are moved, not copied' );
+}
+
+{
+    my ( $xs, $perl ) = ( HTTP::Headers::Fast->new(@headers), HTTP::Headers::Fast->new(@headers) );
+    $xs->remove_content_headers;
+    $perl_remove_content_headers->($perl);
+    is_deeply( {%$xs}, {%$perl}, 'void context' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( map { ( "Content-X$_" => $_, "X-$_" => $_ ) } 1 .. 500 );
+    my $c = $h->remove_content_headers;
+    is( scalar keys %$c, 500, 'many fields: all content ones removed' );
+    is( scalar keys %$h, 500, 'the others left' );
+}
+
+{
+    package My::Headers;
+    our @ISA = ('HTTP::Headers::Fast');
+}
+isa_ok( My::Headers->new( 'Content-Type' => 'a/b' )->remove_content_headers, 'My::Headers', 'subclass' );
+is_deeply( { %{ HTTP::Headers::Fast->new->remove_content_headers } }, {}, 'no fields' );
+
+{
+    my $h = HTTP::Headers::Fast->new( 'Content-Type' => 'text/plain', Host => 'example.com' );
+    $h->as_string;
+    $h->remove_header('Host');
+    is( $h->as_string, "Content-Type: text/plain\n", 'remove_header drops the memoized as_string' );
+    $h->remove_content_headers;
+    is( $h->as_string, '', 'so does remove_content_headers' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->parse_lazy("Host: example.com\r\nContent-Type: text/plain\r\nAccept: */*\r\n\r\n");
+    is_deeply( [ $h->remove_header('Host') ], ['example.com'], 'lazy objects' );
+    isa_ok( $h, 'HTTP::Headers::Fast::Lazy', 'which stay lazy' );
+    is( $h->header('Host'), undef, 'and the field is gone' );
+
+    my $c = $h->remove_content_headers;
+    is_deeply( [ {%$c}, {%$h} ], [ { 'content-type' => 'text/plain' }, { accept => '*/*' } ],
+        'remove_content_headers on lazy objects' );
+}
+
+done_testing;
@@ -0,0 +1,104 @@
+use strict;
+use warnings;
+use Test::More;
+
+use HTTP::Headers::Fast;
+
+my $perl_scan;
+BEGIN { $perl_scan = \&HTTP::Headers::Fast::scan }
+
+use HTTP::Headers::Fast::XS;
+
+isnt( \&HTTP::Headers::Fast::scan, $perl_scan, 'scan is replaced' );
+
+# what a scan with each callback does, calls and the object after
+sub scanned {
+    my ( $scan, $callback ) = @_;
+    my $h = HTTP::Headers::Fast->new(
+        Foo            => [ 1, 2, 3 ],
+        Bar            => 'x',
+        Date           => 'Tue, 11 Nov 2008 01:16:37 GMT',
+        _private       => 1,
+        'Content-Type' => "text/plain\n charset",
+        'X-Obj'        => bless( [ 1, 2 ], 'Some::Class' ),
+    );
+    $h->{':authority'} = 'example.com';
+    $h->{_skipped}     = 'never';
+    my @calls;
+
+    $scan->( $h, sub { push @calls, $callback ? $callback->( $h, @_ ) : [@_] } );
+    return [ \@calls, {%$h} ];
+}
+
+my %callbacks = (
+    'plain'            => undef,
+    'shifting @_'      => sub { my $h = shift; my $name = shift; [ $name, @_ ] },
+    'growing @_'       => sub { my $h = shift; push @_, 'extra'; [@_] },
+    'assigning to @_'  => sub { my $h = shift; $_[1] .= '!' unless ref $_[1]; [@_] },
+    'deleting a field' => sub { my $h = shift; $h->header( Foo => undef ) if $_[0] eq 'Date'; [@_] },
+    'growing an array' => sub { my $h = shift; push @{ $h->{foo} }, 4 if $_[1] eq '1'; [@_] },
+    'setting a field'  => sub { my $h = shift; $h->header( Bar => 'y' ) if $_[0] eq 'Date'; [@_] },
+);
+
+for my $name ( sort keys %callbacks ) {
+    is_deeply(
+        scanned( \&HTTP::Headers::Fast::scan, $callbacks{$name} ),
+        scanned( $perl_scan, $callbacks{$name} ),
+        "same as the perl version: $name",
+    );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x', Date => 'Tue, 11 Nov 2008 01:16:37 GMT' );
+    my ( @xs, @perl );
+    $h->scan( sub { push @xs, "@_"; $h->scan( sub { push @xs, " @_" } ) if $_[0] eq 'Bar' } );
+    $perl_scan->( $h, sub { push @perl, "@_"; $perl_scan->( $h, sub { push @perl, " @_" } ) if $_[0] eq 'Bar' } );
+    is_deeply( \@xs, \@perl, 'nested scans' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x', Date => 'Tue, 11 Nov 2008 01:16:37 GMT' );
+    my ( $depth, @calls ) = (0);
+    my $callback;
+    $callback = sub {
+        push @calls, "$depth $_[0]";
+        if ( $depth < 2 && $_[0] eq 'Bar' ) {
+            $depth++;
+            $h->scan($callback);
+            $depth--;
+        }
+    };
+    $h->scan($callback);
+    is( scalar @calls, 4 * 3, 'scan from its own callback' );
+}
+
+{
+    package Counter;
+    use overload '&{}' => sub { my $self = shift; sub { push @{ $self->{calls} }, $_[0] } };
+}
+
+{
+    my $counter = bless { calls => [] }, 'Counter';
+    HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x' )->scan($counter);
+    my @perl;
+    $perl_scan->( HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x' ), sub { push @perl, $_[0] } );
+    is_deeply( $counter->{calls}, \@perl, 'callbacks that are not plain subs' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new( Foo => [ 1, 2 ], Bar => 'x', Date => 'Tue, 11 Nov 2008 01:16:37 GMT' );
+    my @calls;
+    eval { $h->scan( sub { push @calls, $_[0]; die "stop\n" if $_[0] eq 'Bar' } ) };
+    is( $@, "stop\n", 'dying in the callback' );
+    is( scalar @calls, 2, 'stops the scan' );
+
+    local @_ = ('kept');
+    @calls = ();
+    $h->scan( sub { push @calls, $_[0] } );
+    is( scalar @calls, 4, 'scan works after that' );
+    is_deeply( \@_, ['kept'], 'and @_ is back' );
+}
+
+is_deeply( [ HTTP::Headers::Fast->new( Foo => 1 )->scan( sub { 1 } ) ], [], 'returns nothing' );
+
+done_testing;
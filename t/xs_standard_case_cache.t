@@ -0,0 +1,115 @@
+use strict;
+use warnings;
+use Test::More;
+
+BEGIN {
+    use_ok('HTTP::Headers::Fast');
+    use_ok('HTTP::Headers::Fast::XS');
+}
+
+can_ok( HTTP::Headers::Fast::XS::, 'standard_case_cache_limit' );
+can_ok( HTTP::Headers::Fast::XS::, 'standard_case_cache_stats' );
+
+is(
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(),
+    10000,
+    'cache is bounded by default',
+);
+
+sub stats { HTTP::Headers::Fast::XS::standard_case_cache_stats() }
+
+
+{
+    my $before = stats();
+    HTTP::Headers::Fast::XS::_standardize_field_name('Content-Type');
+    HTTP::Headers::Fast::XS::_standardize_field_name('X-Cache-Test');
+    HTTP::Headers::Fast::XS::_standardize_field_name('x-cache-test');
+    my $after = stats();
+
+    is( $after->{'known'} - $before->{'known'},   1, 'well-known name counted' );
+    is( $after->{'misses'} - $before->{'misses'}, 1, 'new name is a miss' );
+    is( $after->{'hits'} - $before->{'hits'},     1, 'seen name is a hit' );
+    is( $after->{'size'} - $before->{'size'},     1, 'new name is cached' );
+}
+
+{
+    my $h = HTTP::Headers::Fast->new;
+    $h->{'x-raw'} = 1;
+    is( $h->as_string, "x-raw: 1\n", 'until something is evicted, a key set straight in prints as it is' );
+}
+
+{
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(10);
+    is( stats()->{'size'}, 1, 'lowering the limit keeps what fits' );
+
+    my $evictions = stats()->{'evictions'};
+    HTTP::Headers::Fast::XS::_standardize_field_name("X-Flood-$_") for 1 .. 100;
+
+    is( stats()->{'size'}, 10, 'cache does not grow past its limit' );
+    is( stats()->{'evictions'} - $evictions, 91, 'older names were evicted' );
+    is(
+        scalar( grep /^x-flood-|^x-cache-test$/, keys %HTTP::Headers::Fast::standard_case ),
+        10,
+        'evicted names are gone from standard_case',
+    );
+    is(
+        $HTTP::Headers::Fast::standard_case{'content-type'},
+        'Content-Type',
+        'well-known names are never evicted',
+    );
+    is(
+        $HTTP::Headers::Fast::standard_case{'x-flood-100'},
+        'X-Flood-100',
+        'newest name is cached',
+    );
+
+    my $h = HTTP::Headers::Fast->new;
+    $h->{'x-flood-1'} = 1;
+    $h->{'x-flood-2'} = [ 2, 3 ];
+    ok( !exists $HTTP::Headers::Fast::standard_case{'x-flood-1'}, 'x-flood-1 was evicted' );
+    is( $h->as_string, "X-Flood-1: 1\nX-Flood-2: 2\nX-Flood-2: 3\n", 'a field whose name was evicted prints title-cased' );
+    is_deeply( [ $h->header_field_names ], [ 'X-Flood-1', 'X-Flood-2' ], 'header_field_names too' );
+    my @scanned;
+    $h->scan( sub { push @scanned, $_[0] } );
+    is_deeply( \@scanned, [ 'X-Flood-1', 'X-Flood-2', 'X-Flood-2' ], 'scan too' );
+    my $it = $h->iter;
+    my @names;
+    while ( my ($name) = $it->next ) { push @names, $name }
+    is_deeply( \@names, [ 'X-Flood-1', 'X-Flood-2', 'X-Flood-2' ], 'iter too' );
+    $h->{':authority'} = 'example.com';
+    $h->{'_private'}   = 1;
+    is_deeply(
+        [ $h->header_field_names ],
+        [ ':authority', '_private', 'X-Flood-1', 'X-Flood-2' ],
+        "':' and '_' keys are left as they are",
+    );
+
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(3);
+    is( stats()->{'size'}, 3, 'lowering the limit evicts' );
+    is(
+        scalar( grep /^x-flood-/, keys %HTTP::Headers::Fast::standard_case ),
+        3,
+        'down to the new limit',
+    );
+}
+
+{
+    HTTP::Headers::Fast::XS::standard_case_cache_limit(0);
+    HTTP::Headers::Fast::XS::_standardize_field_name("X-Unbounded-$_") for 1 .. 20;
+    is( stats()->{'size'}, 23, 'limit of 0 means unbounded' );
+
+    ok(
+        !eval { HTTP::Headers::Fast::XS::standard_case_cache_limit(-1); 1 },
+        'negative limit is refused',
+    );
+}
+
+{
+    my $h         = HTTP::Headers::Fast->new( 'X-Foo' => 1 );
+    my $evictions = stats()->{'evictions'};
+    HTTP::Headers::Fast::XS::_standardize_field_name("X-Unbounded-$_") for 1 .. 5000;
+    is( $h->as_string, "X-Foo: 1\n", 'unbounded, names of existing fields survive many new names' );
+    is( stats()->{'evictions'}, $evictions, 'nothing is evicted' );
+}
+
+done_testing;
@@ -48,4 +48,129 @@ can_ok( HTTP::Headers::Fast::XS::, '_standardize_field_name' );
     );
 }
 
+{
+    my $std = \&HTTP::Headers::Fast::XS::_standardize_field_name;
+
+    is( $std->('a_b'), 'a-b', 'Translates underscores by default' );
+
+    {
+        local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE;
+        is( $std->('a_b'), 'a_b', 'local() without a value turns it off' );
+
+        {
+            local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 'yes';
+            is( $std->('a_b'), 'a-b', 'nested local() turns it on' );
+        }
+
+        is( $std->('a_b'), 'a_b', 'and it is off again after the inner scope' );
+
+        $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 1;
+        is( $std->('a_b'), 'a-b', 'Plain assignment is seen' );
+
+        $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = '0';
+        is( $std->('a_b'), 'a_b', 'false value is seen' );
+    }
+
+    is( $std->('a_b'), 'a-b', 'Global value is restored after local()' );
+}
+
+{
+    is(
+        HTTP::Headers::Fast::XS::_standardize_field_name('X-FORWARDED-FOR'),
+        'x-forwarded-for',
+        'Well-known name is lowercased',
+    );
+
+    is(
+        $HTTP::Headers::Fast::standard_case{'x-forwarded-for'},
+        'X-FORWARDED-FOR',
+        'Well-known name is spelled as first seen, as the perl version does',
+    );
+
+    is(
+        $HTTP::Headers::Fast::standard_case{'www-authenticate'},
+        'WWW-Authenticate',
+        'HTTP::Headers::Fast spelling of its own headers is kept',
+    );
+}
+
+{
+    is(
+        HTTP::Headers::Fast::XS::_standardize_field_name('CONTENT-TYPO'),
+        'content-typo',
+        'Name close to a well-known one is standardized',
+    );
+
+    is(
+        $HTTP::Headers::Fast::standard_case{'content-typo'},
+        'CONTENT-TYPO',
+        'and falls back to standard_case',
+    );
+}
+
+{
+    # long names go through the vector kernels, in 16 and 32 byte blocks
+    local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 1;
+    my $base = 'x-Some_long.header_NAME-with_MANY-words-0123_abcdefghIJKLMN-a_b';
+
+    for my $len ( 1 .. length $base ) {
+        my $name = substr $base, 0, $len;
+        ( my $expected = $name ) =~ tr/_/-/;
+        ( my $case = $expected ) =~ s/\b(\w)/\u$1/g;
+
+        my $std = HTTP::Headers::Fast::XS::_standardize_field_name($name);
+        is( $std, lc $expected, "Standardized name of length $len" );
+        is(
+            $HTTP::Headers::Fast::standard_case{$std},
+            $case,
+            "standard_case of length $len",
+        ) or last;
+    }
+}
+
+{
+    local $HTTP::Headers::Fast::TRANSLATE_UNDERSCORE = 1;
+    my $name = 'X_Caller_Owned';
+    my $long = 'X_' . ( 'Very_Long_Name_' x 10 );
+    my $copy = $name;
+
+    HTTP::Headers::Fast::XS::_standardize_field_name($name);
+    my $h = HTTP::Headers::Fast->new;
+    $h->header( $name => 1 );
+    $h->header($name);
+    $h->push_header( $name => 2 );
+    $h->_header_get($name);
+    $h->_header_set( $name => 3 );
+    $h->header( $name => 4, $name => 5, $long => 6 );
+    $h->push_header( $long => 7 );
+
+    is( $name, 'X_Caller_Owned', 'Field name argument is not modified' );
+    is( $copy, 'X_Caller_Owned', 'nor is a copy-on-write copy of it' );
+    is(
+        $long,
+        'X_' . ( 'Very_Long_Name_' x 10 ),
+        'nor is a name that does not fit the scratch buffer',
+    );
+    is( $h->header( lc $long ), '6, 7', 'Long name is standardized' );
+    is(
+        $HTTP::Headers::Fast::standard_case{ lc( $long =~ tr/_/-/r ) },
+        'X-' . ( 'Very-Long-Name-' x 10 ),
+        'and gets a standard_case entry',
+    );
+}
+
+{
+    # well-known names are seeded into %standard_case, which output still
+    # reads, so local() overrides show up
+    my $h = HTTP::Headers::Fast->new( ETag => '"x"', 'X-Other' => 1 );
+    local $HTTP::Headers::Fast::standard_case{etag} = 'Etag';
+
+    like( $h->as_string, qr/^Etag: "x"$/m, 'as_string follows %standard_case for well-known names' );
+    my @names;
+    $h->scan( sub { push @names, $_[0] } );
+    is_deeply( [ sort @names ], [ 'Etag', 'X-Other' ], 'so does scan' );
+    is( scalar $h->iter->next, 'Etag', 'and iter' );
+}
+like( HTTP::Headers::Fast->new( ETag => 1 )->as_string, qr/^ETag: 1$/m, 'until it is put back' );
+
 done_testing;
@@ -70,6 +70,28 @@ my @cases = (
             },
         );
     },
+    remove_content_headers => sub {
+        my %more = ( %source, 'Content-Encoding' => 'gzip', 'Last-Modified' => $source{Date} );
+
+        cmpthese(
+            100000 => {
+                orig => sub { my $c = HTTP::Headers->new(%more)->remove_content_headers },
+                fast => sub { my $c = HTTP::Headers::Fast->new(%more)->remove_content_headers },
+            },
+        );
+    },
+    clone => sub {
+        my %more = ( %source, 'Set-Cookie' => [ 'a=1', 'b=2' ] );
+        my $h = HTTP::Headers->new(%more);
+        my $f = HTTP::Headers::Fast->new(%more);
+
+        cmpthese(
+            100000 => {
+                orig => sub { my $c = $h->clone },
+                fast => sub { my $c = $f->clone },
+            },
+        );
+    },
     get_header => sub {
         my $h = HTTP::Headers->new;
         my $f = HTTP::Headers::Fast->new;
@@ -124,6 +146,169 @@ my @cases = (
             },
         );
     },
+    # loads HTTP::Headers::Fast::XS, so keep these last
+    iter => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new(%source);
+
+        cmpthese(
+            100000 => {
+                names  => sub { for my $k ( $f->header_field_names ) { my @v = $f->header($k) } },
+                scan   => sub { $f->scan( sub { } ) },
+                iter   => sub { my $it = $f->iter; while ( my ( $k, $v ) = $it->next ) { } },
+                iter_1 => sub { my $it = $f->iter(1); while ( my ( $k, $v ) = $it->next ) { } },
+            },
+        );
+    },
+    iter_many => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new( %source, map { ( "X-Field-$_" => $_ ) } 1 .. 60 );
+
+        cmpthese(
+            10000 => {
+                names  => sub { for my $k ( $f->header_field_names ) { my @v = $f->header($k) } },
+                scan   => sub { $f->scan( sub { } ) },
+                iter   => sub { my $it = $f->iter; while ( my ( $k, $v ) = $it->next ) { } },
+                iter_1 => sub { my $it = $f->iter(1); while ( my ( $k, $v ) = $it->next ) { } },
+            },
+        );
+    },
+    get_many => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new(%source);
+        my @names = ( 'Content-Type', 'Content-Length', 'Date', 'Host', 'Connection', 'User-Agent' );
+
+        cmpthese(
+            100000 => {
+                header  => sub { my @v = map { scalar $f->header($_) } @names },
+                many    => sub { my @v = $f->get_many(@names) },
+                hashref => sub { my $v = $f->get_many_hashref(@names) },
+            },
+        );
+    },
+    get_header_const => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new('Content-Length' => 100);
+        my $const = eval q{
+            use HTTP::Headers::Fast::XS ':const';
+            sub { $f->header('Content-Length') };
+        } or die $@;
+
+        cmpthese(
+            1000000 => {
+                xs       => sub { $f->header('Content-Length') },
+                xs_const => $const,
+            },
+        );
+    },
+    set_header_const => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new;
+        my $const = eval q{
+            use HTTP::Headers::Fast::XS ':const';
+            sub { $f->header('Content-Length' => 100) };
+        } or die $@;
+
+        cmpthese(
+            1000000 => {
+                xs       => sub { $f->header('Content-Length' => 100) },
+                xs_const => $const,
+            },
+        );
+    },
+    get_header_ops => sub {
+        require HTTP::Headers::Fast::XS;
+        my $f = HTTP::Headers::Fast->new('Content-Length' => 100);
+        my ($ops, $ops_const) = eval q{
+            use HTTP::Headers::Fast::XS ':ops';
+            my $ops = sub { $f->header('Content-Length') };
+            use HTTP::Headers::Fast::XS ':const';
+            ( $ops, sub { $f->header('Content-Length') } );
+        } or die $@;
+
+        cmpthese(
+            1000000 => {
+                xs           => sub { $f->header('Content-Length') },
+                xs_ops       => $ops,
+                xs_ops_const => $ops_const,
+            },
+        );
+    },
+    parse => sub {
+        require HTTP::Headers::Fast::XS;
+        my $block = join( '', map { "$_: $source{$_}\r\n" } sort keys %source ) . "\r\n";
+
+        cmpthese(
+            100000 => {
+                perl => sub {
+                    my $f = HTTP::Headers::Fast->new;
+                    for ( split /\r?\n/, $block ) {
+                        $f->push_header( $1, $2 ) if /^([^\s:]+)\s*:\s*(.*)/;
+                    }
+                },
+                xs => sub { HTTP::Headers::Fast->parse($block) },
+            },
+        );
+    },
+    parse_many => sub {
+        require HTTP::Headers::Fast::XS;
+        my @blocks = map {
+            my $n = $_;
+            join( '', map { "$_: $source{$_}$n\r\n" } sort keys %source ) . "\r\n";
+        } 1 .. 1000;
+
+        cmpthese(
+            200 => {
+                loop      => sub { [ map { HTTP::Headers::Fast->parse($_) } @blocks ] },
+                batch     => sub { HTTP::Headers::Fast::XS::parse_many( \@blocks ) },
+                'batch/2' => sub { HTTP::Headers::Fast::XS::parse_many( \@blocks, [ 'Content-Type', 'Date' ] ) },
+            },
+        );
+    },
+    parse_corpus => sub {
+        require HTTP::Headers::Fast::XS;
+        my $corpus = join '', map {
+            my $n = $_;
+            join( '', map { "$_: $source{$_}$n\r\n" } sort keys %source ) . "\r\n";
+        } 1 .. 100000;
+        my @blocks = $corpus =~ /(.*?\r\n\r\n)/gs;
+
+        cmpthese(
+            10 => {
+                parse_many => sub { HTTP::Headers::Fast::XS::parse_many( \@blocks, ['Content-Type'] ) },
+                map {
+                    my $threads = $_;
+                    ( "threads/$threads" => sub {
+                        HTTP::Headers::Fast::XS::parse_corpus( $corpus, threads => $threads, fields => ['Content-Type'] );
+                    } );
+                } 1, 2, 4, 8,
+            },
+        );
+    },
+    from_psgi_env => sub {
+        require HTTP::Headers::Fast::XS;
+        my %env = (
+            REQUEST_METHOD => 'GET',
+            PATH_INFO      => '/',
+            SERVER_NAME    => 'localhost',
+            ( map { ( my $k = uc "HTTP_$_" ) =~ tr/-/_/; ( $k => $source{$_} ) } keys %source ),
+        );
+
+        cmpthese(
+            100000 => {
+                perl => sub {
+                    my $f = HTTP::Headers::Fast->new;
+                    for ( keys %env ) {
+                        next unless /^(?:HTTP_|CONTENT_(?:TYPE|LENGTH)$)/;
+                        ( my $field = $_ ) =~ s/^HTTPS?_//;
+                        $field =~ tr/_/-/;
+                        $f->push_header( $field, $env{$_} );
+                    }
+                },
+                xs => sub { HTTP::Headers::Fast->from_psgi_env( \%env ) },
+            },
+        );
+    },
 );
 my $only = shift @ARGV;
 print "HTTP::Headers $HTTP::Headers::VERSION, HTTP::Headers::Fast $HTTP::Headers::Fast::VERSION\n";
@@ -0,0 +1,101 @@
+/*
+ * Microbenchmark for the field name folding kernels in fold.h, against
+ * the byte-at-a-time loops handle_standard_case() used before them.
+ *
+ *   cc -O2 -I. -o fold_bench tools/fold_bench.c && ./fold_bench
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fold.h"
+
+#define ROUNDS 2000000
+
+/* translate_underscore() followed by the old lowercase/title-case loops */
+static void fold_field_name_loops(const char *src, char *lc, char *tc, size_t len, int translate) {
+    size_t i;
+    int    word_boundary;
+
+    memcpy(lc, src, len);
+    if (translate)
+        for ( i = 0; i < len; i++ )
+            if ( lc[i] == '_' )
+                lc[i] = '-';
+
+    for ( i = 0; i < len; i++ ) {
+        tc[i] = lc[i];
+        lc[i] = tolower( lc[i] );
+    }
+
+    word_boundary = 1;
+    for ( i = 0; i < len; i++ ) {
+        if (word_boundary)
+            tc[i] = toupper( tc[i] );
+        word_boundary = !( isalnum( (unsigned char) tc[i] ) || tc[i] == '_' );
+    }
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run(fold_fn fn, const char *name, size_t len) {
+    char   lc[128], tc[128];
+    double start = now();
+    long   i;
+
+    for ( i = 0; i < ROUNDS; i++ ) {
+        fn(name, lc, tc, len, 1);
+        __asm__ __volatile__("" : : "r"(lc), "r"(tc) : "memory");
+    }
+    return ( now() - start ) * 1e9 / ROUNDS;
+}
+
+int main(void) {
+    static const char base[] =
+        "X-Amzn-Trace_Id-x-forwarded_proto-X-Request-Start_some-Long-Custom_name-1234";
+    static const size_t lengths[] = { 4, 8, 12, 15, 17, 24, 32, 48, 64 };
+    char   want_lc[128], want_tc[128], got_lc[128], got_tc[128];
+    size_t i;
+
+    fold_init();
+    printf("%6s %10s %10s", "len", "loops", "scalar");
+#ifdef FOLD_HAVE_SSE2
+    printf(" %10s", "sse2");
+#endif
+#ifdef FOLD_HAVE_AVX2
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") )
+        printf(" %10s", "avx2");
+#endif
+    printf("   (ns/call)\n");
+
+    for ( i = 0; i < sizeof(lengths) / sizeof(*lengths); i++ ) {
+        size_t len = lengths[i];
+
+        /* make sure every kernel agrees with the old loops first */
+        fold_field_name_loops(base, want_lc, want_tc, len, 1);
+        fold_field_name(base, got_lc, got_tc, len, 1);
+        if ( memcmp(want_lc, got_lc, len) || memcmp(want_tc, got_tc, len) ) {
+            fprintf(stderr, "kernel mismatch at length %zu\n", len);
+            return 1;
+        }
+
+        printf("%6zu %10.2f %10.2f", len,
+            run(fold_field_name_loops, base, len),
+            run(fold_field_name_scalar, base, len));
+#ifdef FOLD_HAVE_SSE2
+        printf(" %10.2f", run(fold_field_name_sse2, base, len));
+#endif
+#ifdef FOLD_HAVE_AVX2
+        if ( __builtin_cpu_supports("avx2") )
+            printf(" %10.2f", run(fold_field_name_avx2, base, len));
+#endif
+        printf("\n");
+    }
+    return 0;
+}
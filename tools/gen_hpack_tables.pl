@@ -0,0 +1,353 @@
+use strict;
+use warnings;
+
+# Generates hpack_tables.h: the HPACK static table and Huffman code of
+# RFC 7541 (appendices A and B), and the QPACK static table of RFC 9204
+# (appendix A), which shares the Huffman code, for hpack.h.
+#
+#   perl tools/gen_hpack_tables.pl > hpack_tables.h
+#
+# The Huffman code is canonical, so only the code length of each symbol
+# is listed; the codes themselves are rebuilt from those.
+
+my ( @static, @qpack, @lengths );
+my $section = '';
+while (<DATA>) {
+    chomp;
+    if (/^# (\w+)/) {
+        $section = $1;
+        next;
+    }
+    next unless length;
+
+    if ( $section eq 'static' ) {
+        my ( $name, $value ) = split /\t/, $_, 2;
+        push @static, [ $name, defined $value ? $value : '' ];
+    } elsif ( $section eq 'qpack' ) {
+        my ( $name, $value ) = split /\t/, $_, 2;
+        push @qpack, [ $name, defined $value ? $value : '' ];
+    } elsif ( $section eq 'huffman' ) {
+        push @lengths, split ' ';
+    }
+}
+
+die "expected 61 static table entries\n" unless @static == 61;
+die "expected 99 QPACK static table entries\n" unless @qpack == 99;
+die "expected 257 code lengths\n"        unless @lengths == 257;
+
+# canonical code: by length, then by symbol
+my @sorted = sort { $lengths[$a] <=> $lengths[$b] || $a <=> $b } 0 .. 256;
+my ( @code, @first, @count, @offset );
+my ( $code, $len ) = ( 0, $lengths[ $sorted[0] ] );
+for my $i ( 0 .. $#sorted ) {
+    my $sym = $sorted[$i];
+    $code <<= $lengths[$sym] - $len;
+    $len = $lengths[$sym];
+
+    unless ( $count[$len] ) {
+        $first[$len]  = $code;
+        $offset[$len] = $i;
+    }
+    $count[$len]++;
+    $code[$sym] = $code++;
+}
+die "not a complete prefix code\n" unless $code == 1 << $len;
+
+sub c_string {
+    my $s = shift;
+    $s =~ s/(["\\])/\\$1/g;
+    return qq{"$s"};
+}
+
+# QPACK's static table isn't grouped by name: the distinct names, sorted
+# for a binary search, with the first entry of each and a chain through
+# the others
+my ( %qpack_first, @qpack_next );
+for my $i ( reverse 0 .. $#qpack ) {
+    my $name = $qpack[$i][0];
+    $qpack_next[$i] = exists $qpack_first{$name} ? $qpack_first{$name} : -1;
+    $qpack_first{$name} = $i;
+}
+my @qpack_names = sort keys %qpack_first;
+
+sub rows {
+    my ( $per_row, $fmt, @values ) = @_;
+    my $out = '';
+    while ( my @row = splice @values, 0, $per_row ) {
+        $out .= '    ' . join( ', ', map { sprintf $fmt, $_ } @row ) . ",\n";
+    }
+    return $out;
+}
+
+my $out = <<"EOT";
+/*
+ * Generated by tools/gen_hpack_tables.pl -- do not edit.
+ *
+ * RFC 7541 static table (appendix A) and Huffman code (appendix B), and
+ * RFC 9204 static table (appendix A).
+ */
+#ifndef HPACK_TABLES_H
+#define HPACK_TABLES_H
+
+#define HPACK_STATIC_COUNT 61
+
+typedef struct {
+    const char    *name;
+    const char    *value;
+    unsigned char name_len;
+    unsigned char value_len;
+} hpack_static_t;
+
+/* hpack_static[i] is index i + 1 on the wire */
+static const hpack_static_t hpack_static[HPACK_STATIC_COUNT] = {
+EOT
+
+for (@static) {
+    my ( $name, $value ) = @$_;
+    $out .= sprintf "    { %-30s %-16s %2d, %2d },\n",
+        c_string($name) . ',', c_string($value) . ',', length $name, length $value;
+}
+
+$out .= <<"EOT";
+};
+
+#define QPACK_STATIC_COUNT @{[ scalar @qpack ]}
+#define QPACK_STATIC_NAMES @{[ scalar @qpack_names ]}
+
+/* qpack_static[i] is index i on the wire */
+static const hpack_static_t qpack_static[QPACK_STATIC_COUNT] = {
+EOT
+
+for (@qpack) {
+    my ( $name, $value ) = @$_;
+    $out .= sprintf "    { %-35s %-58s %2d, %2d },\n",
+        c_string($name) . ',', c_string($value) . ',', length $name, length $value;
+}
+
+$out .= <<"EOT";
+};
+
+/* the next entry with the same name, or -1 */
+static const signed char qpack_static_next[QPACK_STATIC_COUNT] = {
+@{[ rows( 16, '%2d', @qpack_next ) ]}};
+
+/* the first entry of each name, by name */
+static const unsigned char qpack_static_names[QPACK_STATIC_NAMES] = {
+@{[ rows( 16, '%2d', map { $qpack_first{$_} } @qpack_names ) ]}};
+EOT
+
+my $max = $lengths[ $sorted[-1] ];
+$out .= <<"EOT";
+
+#define HPACK_HUFFMAN_EOS     256
+#define HPACK_HUFFMAN_MAX_LEN $max
+
+/* code and length of every symbol, EOS last */
+static const U32 hpack_huffman_code[257] = {
+@{[ rows( 8, '0x%08x', @code ) ]}};
+
+static const unsigned char hpack_huffman_len[257] = {
+@{[ rows( 16, '%2d', @lengths ) ]}};
+
+/* for decoding: the first code of each length, how many codes have
+ * that length, and where their symbols start in hpack_huffman_sym[] */
+static const U32 hpack_huffman_first[HPACK_HUFFMAN_MAX_LEN + 1] = {
+@{[ rows( 8, '0x%08x', map { $first[$_] || 0 } 0 .. $max ) ]}};
+
+static const unsigned short hpack_huffman_count[HPACK_HUFFMAN_MAX_LEN + 1] = {
+@{[ rows( 16, '%2d', map { $count[$_] || 0 } 0 .. $max ) ]}};
+
+static const unsigned short hpack_huffman_offset[HPACK_HUFFMAN_MAX_LEN + 1] = {
+@{[ rows( 16, '%3d', map { $offset[$_] || 0 } 0 .. $max ) ]}};
+
+static const unsigned short hpack_huffman_sym[257] = {
+@{[ rows( 16, '%3d', @sorted ) ]}};
+
+#endif /* HPACK_TABLES_H */
+EOT
+
+print $out;
+
+__DATA__
+# static
+:authority
+:method	GET
+:method	POST
+:path	/
+:path	/index.html
+:scheme	http
+:scheme	https
+:status	200
+:status	204
+:status	206
+:status	304
+:status	400
+:status	404
+:status	500
+accept-charset
+accept-encoding	gzip, deflate
+accept-language
+accept-ranges
+accept
+access-control-allow-origin
+age
+allow
+authorization
+cache-control
+content-disposition
+content-encoding
+content-language
+content-length
+content-location
+content-range
+content-type
+cookie
+date
+etag
+expect
+expires
+from
+host
+if-match
+if-modified-since
+if-none-match
+if-range
+if-unmodified-since
+last-modified
+link
+location
+max-forwards
+proxy-authenticate
+proxy-authorization
+range
+referer
+refresh
+retry-after
+server
+set-cookie
+strict-transport-security
+transfer-encoding
+user-agent
+vary
+via
+www-authenticate
+
+# qpack
+:authority
+:path	/
+age	0
+content-disposition
+content-length	0
+cookie
+date
+etag
+if-modified-since
+if-none-match
+last-modified
+link
+location
+referer
+set-cookie
+:method	CONNECT
+:method	DELETE
+:method	GET
+:method	HEAD
+:method	OPTIONS
+:method	POST
+:method	PUT
+:scheme	http
+:scheme	https
+:status	103
+:status	200
+:status	304
+:status	404
+:status	503
+accept	*/*
+accept	application/dns-message
+accept-encoding	gzip, deflate, br
+accept-ranges	bytes
+access-control-allow-headers	cache-control
+access-control-allow-headers	content-type
+access-control-allow-origin	*
+cache-control	max-age=0
+cache-control	max-age=2592000
+cache-control	max-age=604800
+cache-control	no-cache
+cache-control	no-store
+cache-control	public, max-age=31536000
+content-encoding	br
+content-encoding	gzip
+content-type	application/dns-message
+content-type	application/javascript
+content-type	application/json
+content-type	application/x-www-form-urlencoded
+content-type	image/gif
+content-type	image/jpeg
+content-type	image/png
+content-type	text/css
+content-type	text/html; charset=utf-8
+content-type	text/plain
+content-type	text/plain;charset=utf-8
+range	bytes=0-
+strict-transport-security	max-age=31536000
+strict-transport-security	max-age=31536000; includesubdomains
+strict-transport-security	max-age=31536000; includesubdomains; preload
+vary	accept-encoding
+vary	origin
+x-content-type-options	nosniff
+x-xss-protection	1; mode=block
+:status	100
+:status	204
+:status	206
+:status	302
+:status	400
+:status	403
+:status	421
+:status	425
+:status	500
+accept-language
+access-control-allow-credentials	FALSE
+access-control-allow-credentials	TRUE
+access-control-allow-headers	*
+access-control-allow-methods	get
+access-control-allow-methods	get, post, options
+access-control-allow-methods	options
+access-control-expose-headers	content-length
+access-control-request-headers	content-type
+access-control-request-method	get
+access-control-request-method	post
+alt-svc	clear
+authorization
+content-security-policy	script-src 'none'; object-src 'none'; base-uri 'none'
+early-data	1
+expect-ct
+forwarded
+if-range
+origin
+purpose	prefetch
+server
+timing-allow-origin	*
+upgrade-insecure-requests	1
+user-agent
+x-forwarded-for
+x-frame-options	deny
+x-frame-options	sameorigin
+
+# huffman: code length of symbols 0 to 255, then EOS
+13 23 28 28 28 28 28 28 28 24 30 28 28 30 28 28
+28 28 28 28 28 28 30 28 28 28 28 28 28 28 28 28
+6 10 10 12 13 6 8 11 10 10 8 11 8 6 6 6
+5 5 5 6 6 6 6 6 6 6 7 8 15 6 12 10
+13 6 7 7 7 7 7 7 7 7 7 7 7 7 7 7
+7 7 7 7 7 7 7 7 8 7 8 13 19 13 14 6
+15 5 6 5 6 5 6 6 6 5 7 7 6 6 6 5
+6 7 6 5 5 6 7 7 7 7 7 15 11 14 13 28
+20 22 20 20 22 22 22 23 22 23 23 23 23 23 24 23
+24 24 22 23 24 23 23 23 23 21 22 23 22 23 23 24
+22 21 20 22 22 23 23 21 23 22 22 24 21 22 23 23
+21 21 22 21 23 22 23 23 20 22 22 22 23 22 22 23
+26 26 20 19 22 23 22 25 26 26 26 27 27 26 24 25
+19 21 26 27 27 26 27 24 21 21 26 26 28 27 27 27
+20 24 20 21 22 21 21 23 22 22 25 25 24 24 26 23
+26 27 26 26 27 27 27 27 27 28 27 27 27 27 27 26
+30
@@ -0,0 +1,334 @@
+use strict;
+use warnings;
+
+# Generates known_headers.h: a compile-time perfect hash of well-known
+# header names, so handle_standard_case() can resolve @header_order names
+# without touching %HTTP::Headers::Fast::standard_case, and the rest with
+# their hash and shared key at hand. Only the @header_order names get a
+# %standard_case spelling: HTTP::Headers::Fast spells any other name as
+# it first sees it, and so must we.
+#
+#   perl tools/gen_known_headers.pl > known_headers.h
+
+# the first group of names below is HTTP::Headers::Fast's @header_order,
+# so their position in it is their as_string() sort rank
+my ( @names, %order );
+my $group = 0;
+while (<DATA>) {
+    $group++ if /^#/;
+    s/#.*//;
+    s/^\s+|\s+$//g;
+    next unless length;
+
+    push @names, $_;
+    $order{$_} = @names if $group == 1;
+}
+
+# HTTP::Headers::Fast's @entity_headers, which remove_content_headers()
+# takes along with any name starting with "content-"
+my %entity = map { lc($_) => 1 } qw(
+    Allow Content-Encoding Content-Language Content-Length Content-Location
+    Content-MD5 Content-Range Content-Type Expires Last-Modified
+);
+
+my %seen;
+for (@names) {
+    die "duplicate header name: $_\n" if $seen{ lc $_ }++;
+}
+
+my $slots   = 256;
+my $buckets = 64;
+my $bits    = log($slots) / log(2);
+
+die "too many names for $slots slots\n" if @names > $slots;
+
+sub fnv1a {
+    use integer;
+    my $h = 0x811c9dc5;
+    for my $c ( unpack 'C*', shift ) {
+        $h ^= $c;
+        $h = ( $h * 16777619 ) & 0xffffffff;
+    }
+    return $h;
+}
+
+sub slot_for {
+    use integer;
+    my ( $h, $disp ) = @_;
+    my $x = ( ( $h ^ $disp ) * 0x9E3779B1 ) & 0xffffffff;
+    return ( $x >> ( 32 - $bits ) ) & ( $slots - 1 );
+}
+
+# hash and displace: place the fullest buckets first, searching for a
+# displacement that maps all of a bucket's keys onto free slots
+my @hash = map { fnv1a( lc $_ ) } @names;
+my @in_bucket;
+push @{ $in_bucket[ $hash[$_] % $buckets ] }, $_ for 0 .. $#names;
+
+my @disp = (0) x $buckets;
+my @slot = (-1) x $slots;
+
+for my $b ( sort { @{ $in_bucket[$b] || [] } <=> @{ $in_bucket[$a] || [] } || $a <=> $b } 0 .. $buckets - 1 ) {
+    my $keys = $in_bucket[$b] or next;
+    my $found;
+    DISP: for my $d ( 0 .. 0xffff ) {
+        my %taken;
+        for my $k (@$keys) {
+            my $s = slot_for( $hash[$k], $d );
+            next DISP if $slot[$s] >= 0 || $taken{$s}++;
+        }
+        $slot[ slot_for( $hash[$_], $d ) ] = $_ for @$keys;
+        $disp[$b] = $found = $d;
+        last;
+    }
+    die "no displacement found for bucket $b\n" unless defined $found;
+}
+
+my ( $min, $max ) = ( 255, 0 );
+for (@names) {
+    $min = length($_) if length($_) < $min;
+    $max = length($_) if length($_) > $max;
+}
+
+my $out = <<"EOT";
+/*
+ * Generated by tools/gen_known_headers.pl -- do not edit.
+ *
+ * Perfect hash of well-known header names: every name below lands in its
+ * own slot of known_header_slot[], so a lookup is one hash pass over the
+ * lowercased name, one displacement fetch and one memcmp().
+ */
+#ifndef KNOWN_HEADERS_H
+#define KNOWN_HEADERS_H
+
+#define KNOWN_HEADER_COUNT   @{[ scalar @names ]}
+#define KNOWN_HEADER_SLOTS   $slots
+#define KNOWN_HEADER_BUCKETS $buckets
+#define KNOWN_HEADER_MIN_LEN $min
+#define KNOWN_HEADER_MAX_LEN $max
+
+/* as_string() rank of names missing from HTTP::Headers::Fast's %header_order */
+#define KNOWN_HEADER_NO_ORDER 999
+
+typedef struct {
+    const char     *name;      /* lowercased, as used for object keys */
+    const char     *canonical; /* %standard_case value seeded at boot, or NULL */
+    unsigned char  len;
+    unsigned short order;      /* %header_order rank */
+} known_header_t;
+
+static const known_header_t known_headers[KNOWN_HEADER_COUNT] = {
+EOT
+
+for my $i ( 0 .. $#names ) {
+    my $n = $names[$i];
+    $out .= sprintf qq{    { %-38s %-38s %2d, %s },\n},
+        '"' . lc($n) . '",', $order{$n} ? qq{"$n",} : 'NULL,', length $n,
+        $order{$n} ? sprintf( '%3d', $order{$n} ) : 'KNOWN_HEADER_NO_ORDER';
+}
+
+$out .= "};\n\nstatic const unsigned short known_header_disp[KNOWN_HEADER_BUCKETS] = {\n";
+$out .= join '', map {
+    '    ' . join( ', ', @disp[ $_ .. ( $_ + 7 < $#disp ? $_ + 7 : $#disp ) ] ) . ",\n"
+} grep { $_ % 8 == 0 } 0 .. $#disp;
+
+$out .= "};\n\nstatic const short known_header_slot[KNOWN_HEADER_SLOTS] = {\n";
+$out .= join '', map {
+    '    ' . join( ', ', map { sprintf '%3d', $_ } @slot[ $_ .. $_ + 15 ] ) . ",\n"
+} grep { $_ % 16 == 0 } 0 .. $#slot;
+
+my @content = (0) x int( ( @names + 7 ) / 8 );
+for my $i ( 0 .. $#names ) {
+    my $lc = lc $names[$i];
+    $content[ $i >> 3 ] |= 1 << ( $i & 7 ) if $entity{$lc} || $lc =~ /^content-/;
+}
+
+$out .= "};\n\n/* Bit i is set when remove_content_headers() takes known_headers[i] */\n";
+$out .= "static const unsigned char known_header_content[(KNOWN_HEADER_COUNT + 7) / 8] = {\n";
+$out .= join '', map {
+    '    ' . join( ', ', map { sprintf '0x%02x', $_ } @content[ $_ .. ( $_ + 7 < $#content ? $_ + 7 : $#content ) ] ) . ",\n"
+} grep { $_ % 8 == 0 } 0 .. $#content;
+
+$out .= <<"EOT";
+};
+
+static U32 known_header_hash(const char *name, STRLEN len) {
+    U32    h = 0x811c9dc5;
+    STRLEN i;
+
+    for ( i = 0; i < len; i++ ) {
+        h ^= (unsigned char) name[i];
+        h *= 16777619;
+    }
+    return h;
+}
+
+/* Returns the index into known_headers[] of a lowercased name, or -1 */
+static int known_header_lookup(const char *name, STRLEN len) {
+    U32 h;
+    int i;
+
+    if ( len < KNOWN_HEADER_MIN_LEN || len > KNOWN_HEADER_MAX_LEN )
+        return -1;
+
+    h = known_header_hash(name, len);
+    h = ( h ^ known_header_disp[h % KNOWN_HEADER_BUCKETS] ) * 0x9E3779B1U;
+    i = known_header_slot[ h >> (32 - $bits) ];
+
+    if ( i < 0 || known_headers[i].len != len
+      || memcmp(known_headers[i].name, name, len) != 0 )
+        return -1;
+
+    return i;
+}
+
+/* Returns the %header_order rank of an object key, as _sorted_field_names() uses it */
+static int known_header_order(const char *name, STRLEN len) {
+    int i = known_header_lookup(name, len);
+
+    return i < 0 ? KNOWN_HEADER_NO_ORDER : known_headers[i].order;
+}
+
+/* Whether remove_content_headers() takes an object key: an entity header,
+ * or any name starting with "content-" */
+static int known_header_is_content(const char *name, STRLEN len) {
+    int i;
+
+    if ( len >= 8 && memcmp(name, "content-", 8) == 0 )
+        return 1;
+
+    i = known_header_lookup(name, len);
+    return i >= 0 && ( known_header_content[i >> 3] >> ( i & 7 ) & 1 );
+}
+
+#endif /* KNOWN_HEADERS_H */
+EOT
+
+print $out;
+
+__DATA__
+# HTTP::Headers::Fast's own @header_order, spelled as it spells them
+Cache-Control
+Connection
+Date
+Pragma
+Trailer
+Transfer-Encoding
+Upgrade
+Via
+Warning
+Accept
+Accept-Charset
+Accept-Encoding
+Accept-Language
+Authorization
+Expect
+From
+Host
+If-Match
+If-Modified-Since
+If-None-Match
+If-Range
+If-Unmodified-Since
+Max-Forwards
+Proxy-Authorization
+Range
+Referer
+TE
+User-Agent
+Accept-Ranges
+Age
+ETag
+Location
+Proxy-Authenticate
+Retry-After
+Server
+Vary
+WWW-Authenticate
+Allow
+Content-Encoding
+Content-Language
+Content-Length
+Content-Location
+Content-MD5
+Content-Range
+Content-Type
+Expires
+Last-Modified
+
+# IANA HTTP Field Name Registry (permanent)
+A-IM
+Accept-CH
+Accept-Patch
+Accept-Post
+Access-Control-Allow-Credentials
+Access-Control-Allow-Headers
+Access-Control-Allow-Methods
+Access-Control-Allow-Origin
+Access-Control-Expose-Headers
+Access-Control-Max-Age
+Access-Control-Request-Headers
+Access-Control-Request-Method
+ALPN
+Alt-Svc
+Alt-Used
+Authentication-Info
+Cache-Status
+CDN-Cache-Control
+Clear-Site-Data
+Content-Digest
+Content-Disposition
+Content-Security-Policy
+Content-Security-Policy-Report-Only
+Cookie
+Cross-Origin-Embedder-Policy
+Cross-Origin-Opener-Policy
+Cross-Origin-Resource-Policy
+Delta-Base
+Digest
+Early-Data
+Expect-CT
+Forwarded
+HTTP2-Settings
+IM
+Keep-Alive
+Link
+Origin
+Permissions-Policy
+Prefer
+Preference-Applied
+Priority
+Proxy-Authentication-Info
+Proxy-Status
+Purpose
+Refresh
+Referrer-Policy
+Repr-Digest
+Sec-Fetch-Dest
+Sec-Fetch-Mode
+Sec-Fetch-Site
+Sec-Fetch-User
+Sec-WebSocket-Accept
+Sec-WebSocket-Extensions
+Sec-WebSocket-Key
+Sec-WebSocket-Protocol
+Sec-WebSocket-Version
+Server-Timing
+Set-Cookie
+SourceMap
+Strict-Transport-Security
+Timing-Allow-Origin
+Upgrade-Insecure-Requests
+Want-Content-Digest
+Want-Repr-Digest
+X-Content-Type-Options
+X-Frame-Options
+
+# de facto standards, common enough to be worth a slot
+DNT
+X-Forwarded-For
+X-Forwarded-Host
+X-Forwarded-Proto
+X-Real-IP
+X-Requested-With
+X-XSS-Protection